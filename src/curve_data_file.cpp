@@ -0,0 +1,702 @@
+#include "curve_data_file.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <cstring>
+
+namespace godot
+{
+
+const char *CurveDataFile::MAGIC = "CMCV";
+
+namespace
+{
+constexpr int HEADER_SIZE = 56;
+constexpr int INDEX_ENTRY_SIZE = 40;
+
+static void _store_aabb(const Ref<FileAccess> &p_file, const AABB &p_aabb)
+{
+    p_file->store_float(p_aabb.position.x);
+    p_file->store_float(p_aabb.position.y);
+    p_file->store_float(p_aabb.position.z);
+    p_file->store_float(p_aabb.size.x);
+    p_file->store_float(p_aabb.size.y);
+    p_file->store_float(p_aabb.size.z);
+}
+
+static AABB _decode_aabb(const PackedByteArray &p_bytes, int64_t p_offset)
+{
+    return AABB(Vector3(p_bytes.decode_float(p_offset),
+                        p_bytes.decode_float(p_offset + 4),
+                        p_bytes.decode_float(p_offset + 8)),
+                Vector3(p_bytes.decode_float(p_offset + 12),
+                        p_bytes.decode_float(p_offset + 16),
+                        p_bytes.decode_float(p_offset + 20)));
+}
+
+// Length of a cubic Bezier segment. The chord and the control polygon bound
+// the arc from below and above, and their mean converges quickly as the
+// segment is split, so this matches the tessellated length the meshes use.
+static double _get_bezier_length(const Vector3 &p_a, const Vector3 &p_b,
+                                 const Vector3 &p_c, const Vector3 &p_d,
+                                 int p_depth = 0)
+{
+    const double chord = p_a.distance_to(p_d);
+    const double polygon = p_a.distance_to(p_b) + p_b.distance_to(p_c) +
+                           p_c.distance_to(p_d);
+    if (p_depth >= 8 || polygon - chord <= polygon * 1.0e-4)
+    {
+        return (chord + polygon) * 0.5;
+    }
+
+    const Vector3 ab = (p_a + p_b) * 0.5f;
+    const Vector3 bc = (p_b + p_c) * 0.5f;
+    const Vector3 cd = (p_c + p_d) * 0.5f;
+    const Vector3 abc = (ab + bc) * 0.5f;
+    const Vector3 bcd = (bc + cd) * 0.5f;
+    const Vector3 mid = (abc + bcd) * 0.5f;
+    return _get_bezier_length(p_a, ab, abc, mid, p_depth + 1) +
+           _get_bezier_length(mid, bcd, cd, p_d, p_depth + 1);
+}
+} // namespace
+
+Error CurveDataFile::_write(const String &p_path, const Points &p_points,
+                            bool p_closed, int p_chunk_size)
+{
+    const int64_t count = p_points.positions.size();
+    ERR_FAIL_COND_V_MSG(count == 0, ERR_INVALID_PARAMETER,
+                        "CurveDataFile: no points to save.");
+
+    const bool has_handles = p_points.in_handles.size() == count &&
+                             p_points.out_handles.size() == count;
+    const bool has_tilts = p_points.tilts.size() == count;
+    const bool has_widths = p_points.widths.size() == count;
+    const uint32_t file_flags = (has_handles ? FLAG_HANDLES : 0) |
+                                (has_tilts ? FLAG_TILTS : 0) |
+                                (has_widths ? FLAG_WIDTHS : 0) |
+                                (p_closed ? FLAG_CLOSED : 0);
+    const int floats_per_point =
+        3 + (has_handles ? 6 : 0) + (has_tilts ? 1 : 0) + (has_widths ? 1 : 0);
+    const int chunk_points = Math::max(p_chunk_size, 2);
+    const int64_t chunk_count = (count + chunk_points - 1) / chunk_points;
+
+    const Vector3 *positions = p_points.positions.ptr();
+    const Vector3 *in_handles = p_points.in_handles.ptr();
+    const Vector3 *out_handles = p_points.out_handles.ptr();
+
+    // Bounds cover the handles too, since the curve stays inside the hull
+    // of its control points. Distances are measured along the curve, so
+    // spans of a file with handles get the length they are built with.
+    auto segment_length = [&](int64_t p_from, int64_t p_to) -> double
+    {
+        if (!has_handles)
+        {
+            return positions[p_to].distance_to(positions[p_from]);
+        }
+        return _get_bezier_length(
+            positions[p_from], positions[p_from] + out_handles[p_from],
+            positions[p_to] + in_handles[p_to], positions[p_to]);
+    };
+    LocalVector<AABB> chunk_bounds;
+    LocalVector<float> chunk_distances;
+    chunk_bounds.resize(chunk_count);
+    chunk_distances.resize(chunk_count);
+    double distance = 0.0;
+    for (int64_t c = 0; c < chunk_count; c++)
+    {
+        const int64_t begin = c * chunk_points;
+        const int64_t end = Math::min(begin + chunk_points, count);
+        AABB aabb(positions[begin], Vector3());
+        for (int64_t i = begin; i < end; i++)
+        {
+            if (i > begin || c > 0)
+            {
+                distance += segment_length(i - 1, i);
+            }
+            if (i == begin)
+            {
+                chunk_distances[c] = distance;
+            }
+            aabb.expand_to(positions[i]);
+            if (has_handles)
+            {
+                aabb.expand_to(positions[i] + in_handles[i]);
+                aabb.expand_to(positions[i] + out_handles[i]);
+            }
+        }
+        chunk_bounds[c] = aabb;
+    }
+    if (p_closed)
+    {
+        distance += segment_length(count - 1, 0);
+    }
+    AABB file_bounds = chunk_bounds[0];
+    for (const AABB &aabb : chunk_bounds)
+    {
+        file_bounds.merge_with(aabb);
+    }
+
+    Ref<FileAccess> out = FileAccess::open(p_path, FileAccess::WRITE);
+    ERR_FAIL_COND_V_MSG(out.is_null(), FileAccess::get_open_error(),
+                        "CurveDataFile: cannot write '" + p_path + "'.");
+
+    PackedByteArray magic;
+    magic.resize(4);
+    for (int i = 0; i < 4; i++)
+    {
+        magic.set(i, MAGIC[i]);
+    }
+    out->store_buffer(magic);
+    out->store_32(VERSION);
+    out->store_32(file_flags);
+    out->store_32(chunk_points);
+    out->store_64(count);
+    out->store_32(chunk_count);
+    out->store_float(distance);
+    _store_aabb(out, file_bounds);
+
+    uint64_t offset = HEADER_SIZE + chunk_count * INDEX_ENTRY_SIZE;
+    for (int64_t c = 0; c < chunk_count; c++)
+    {
+        const int64_t begin = c * chunk_points;
+        const int64_t chunk_count_points =
+            Math::min(begin + chunk_points, count) - begin;
+        out->store_64(offset);
+        out->store_32(chunk_count_points);
+        out->store_float(chunk_distances[c]);
+        _store_aabb(out, chunk_bounds[c]);
+        offset += chunk_count_points * floats_per_point * sizeof(float);
+    }
+
+    // Each array of a chunk is contiguous, so a reader copies it in one go.
+    PackedFloat32Array data;
+    for (int64_t c = 0; c < chunk_count; c++)
+    {
+        const int64_t begin = c * chunk_points;
+        const int64_t end = Math::min(begin + chunk_points, count);
+        data.resize((end - begin) * floats_per_point);
+        float *write = data.ptrw();
+        auto store_vectors = [&](const Vector3 *p_vectors)
+        {
+            for (int64_t i = begin; i < end; i++)
+            {
+                *write++ = p_vectors[i].x;
+                *write++ = p_vectors[i].y;
+                *write++ = p_vectors[i].z;
+            }
+        };
+        auto store_floats = [&](const float *p_floats)
+        {
+            for (int64_t i = begin; i < end; i++)
+            {
+                *write++ = p_floats[i];
+            }
+        };
+
+        store_vectors(positions);
+        if (has_handles)
+        {
+            store_vectors(in_handles);
+            store_vectors(out_handles);
+        }
+        if (has_tilts)
+        {
+            store_floats(p_points.tilts.ptr());
+        }
+        if (has_widths)
+        {
+            store_floats(p_points.widths.ptr());
+        }
+        out->store_buffer(data.to_byte_array());
+    }
+
+    return out->get_error();
+}
+
+Error CurveDataFile::save_points(const String &p_path,
+                                 const PackedVector3Array &p_positions,
+                                 const PackedFloat32Array &p_tilts,
+                                 const PackedFloat32Array &p_widths,
+                                 bool p_closed, int p_chunk_size)
+{
+    ERR_FAIL_COND_V_MSG(!p_tilts.is_empty() &&
+                            p_tilts.size() != p_positions.size(),
+                        ERR_INVALID_PARAMETER,
+                        "CurveDataFile: tilts must be empty or match the "
+                        "positions in size.");
+    ERR_FAIL_COND_V_MSG(!p_widths.is_empty() &&
+                            p_widths.size() != p_positions.size(),
+                        ERR_INVALID_PARAMETER,
+                        "CurveDataFile: widths must be empty or match the "
+                        "positions in size.");
+
+    Points points;
+    points.positions = p_positions;
+    points.tilts = p_tilts;
+    points.widths = p_widths;
+    return _write(p_path, points, p_closed, p_chunk_size);
+}
+
+Error CurveDataFile::save_curve(const String &p_path,
+                                const Ref<Curve3D> &p_curve,
+                                const PackedFloat32Array &p_widths,
+                                int p_chunk_size)
+{
+    ERR_FAIL_COND_V(p_curve.is_null(), ERR_INVALID_PARAMETER);
+
+    const int64_t count = p_curve->get_point_count();
+    ERR_FAIL_COND_V_MSG(!p_widths.is_empty() && p_widths.size() != count,
+                        ERR_INVALID_PARAMETER,
+                        "CurveDataFile: widths must be empty or match the "
+                        "control points in size.");
+    Points points;
+    points.positions.resize(count);
+    points.in_handles.resize(count);
+    points.out_handles.resize(count);
+    points.tilts.resize(count);
+    for (int64_t i = 0; i < count; i++)
+    {
+        points.positions.set(i, p_curve->get_point_position(i));
+        points.in_handles.set(i, p_curve->get_point_in(i));
+        points.out_handles.set(i, p_curve->get_point_out(i));
+        points.tilts.set(i, p_curve->get_point_tilt(i));
+    }
+    points.widths = p_widths;
+    return _write(p_path, points, p_curve->is_closed(), p_chunk_size);
+}
+
+Error CurveDataFile::_open()
+{
+    _close();
+    if (file_path.is_empty())
+    {
+        return ERR_FILE_NOT_FOUND;
+    }
+
+    Ref<FileAccess> in = FileAccess::open(file_path, FileAccess::READ);
+    ERR_FAIL_COND_V_MSG(in.is_null(), FileAccess::get_open_error(),
+                        "CurveDataFile: cannot open '" + file_path + "'.");
+
+    const PackedByteArray header = in->get_buffer(HEADER_SIZE);
+    ERR_FAIL_COND_V_MSG(header.size() != HEADER_SIZE, ERR_FILE_CORRUPT,
+                        "CurveDataFile: '" + file_path + "' is truncated.");
+    for (int i = 0; i < 4; i++)
+    {
+        ERR_FAIL_COND_V_MSG(header[i] != (uint8_t)MAGIC[i],
+                            ERR_FILE_UNRECOGNIZED,
+                            "CurveDataFile: '" + file_path +
+                                "' is not a curve data file.");
+    }
+    ERR_FAIL_COND_V_MSG(header.decode_u32(4) != VERSION,
+                        ERR_FILE_UNRECOGNIZED,
+                        "CurveDataFile: '" + file_path +
+                            "' has an unsupported version.");
+
+    const uint32_t file_flags = header.decode_u32(8);
+    const int file_chunk_size = header.decode_u32(12);
+    const int64_t file_point_count = header.decode_u64(16);
+    const int64_t chunk_count = header.decode_u32(24);
+    const uint64_t file_length = in->get_length();
+    ERR_FAIL_COND_V_MSG(file_chunk_size <= 0 || file_point_count <= 0 ||
+                            (uint64_t)chunk_count * INDEX_ENTRY_SIZE >
+                                file_length,
+                        ERR_FILE_CORRUPT,
+                        "CurveDataFile: '" + file_path + "' is corrupt.");
+
+    const PackedByteArray index =
+        in->get_buffer(chunk_count * INDEX_ENTRY_SIZE);
+    ERR_FAIL_COND_V_MSG(index.size() != chunk_count * INDEX_ENTRY_SIZE,
+                        ERR_FILE_CORRUPT,
+                        "CurveDataFile: '" + file_path + "' is truncated.");
+
+    // Points are found by dividing by the chunk size, so every chunk but
+    // the last must be full, and each must lie inside the file.
+    const int floats_per_point = 3 + ((file_flags & FLAG_HANDLES) ? 6 : 0) +
+                                 ((file_flags & FLAG_TILTS) ? 1 : 0) +
+                                 ((file_flags & FLAG_WIDTHS) ? 1 : 0);
+    const uint64_t stride = floats_per_point * sizeof(float);
+    int64_t total_count = 0;
+    LocalVector<ChunkInfo> file_chunks;
+    file_chunks.resize(chunk_count);
+    for (int64_t c = 0; c < chunk_count; c++)
+    {
+        const int64_t entry = c * INDEX_ENTRY_SIZE;
+        const uint64_t offset = index.decode_u64(entry);
+        const int64_t count = index.decode_u32(entry + 8);
+        const bool last = c == chunk_count - 1;
+        ERR_FAIL_COND_V_MSG(
+            count <= 0 || count > file_chunk_size ||
+                (!last && count != file_chunk_size) ||
+                offset > file_length ||
+                (uint64_t)count * stride > file_length - offset,
+            ERR_FILE_CORRUPT,
+            "CurveDataFile: '" + file_path + "' has a corrupt index.");
+        total_count += count;
+
+        file_chunks[c].offset = offset;
+        file_chunks[c].count = count;
+        file_chunks[c].distance = index.decode_float(entry + 12);
+        file_chunks[c].bounds = _decode_aabb(index, entry + 16);
+        file_chunks[c].begin = c * file_chunk_size;
+    }
+    ERR_FAIL_COND_V_MSG(total_count != file_point_count, ERR_FILE_CORRUPT,
+                        "CurveDataFile: '" + file_path +
+                            "' has a corrupt index.");
+
+    file = in;
+    flags = file_flags;
+    chunks = file_chunks;
+    chunk_size = file_chunk_size;
+    point_count = file_point_count;
+    length = header.decode_float(28);
+    bounds = _decode_aabb(header, 32);
+    return OK;
+}
+
+void CurveDataFile::_close()
+{
+    file.unref();
+    flags = 0;
+    chunk_size = 0;
+    point_count = 0;
+    length = 0.0f;
+    bounds = AABB();
+    chunks.clear();
+    cache.clear();
+}
+
+const CurveDataFile::Points *CurveDataFile::_get_chunk(int64_t p_chunk)
+{
+    use_counter++;
+    int slot = -1;
+    for (uint32_t i = 0; i < cache.size(); i++)
+    {
+        if (cache[i].index == p_chunk)
+        {
+            cache[i].last_use = use_counter;
+            return &cache[i].points;
+        }
+        if (slot < 0 || cache[i].last_use < cache[slot].last_use)
+        {
+            slot = i;
+        }
+    }
+    if ((int)cache.size() < cache_size)
+    {
+        cache.push_back(CachedChunk());
+        slot = cache.size() - 1;
+    }
+
+    const bool file_handles = flags & FLAG_HANDLES;
+    const bool file_tilts = flags & FLAG_TILTS;
+    const bool file_widths = flags & FLAG_WIDTHS;
+    const ChunkInfo &info = chunks[p_chunk];
+    const int floats_per_point = 3 + (file_handles ? 6 : 0) +
+                                 (file_tilts ? 1 : 0) + (file_widths ? 1 : 0);
+    const int64_t byte_count =
+        (int64_t)info.count * floats_per_point * sizeof(float);
+
+    file->seek(info.offset);
+    const PackedByteArray bytes = file->get_buffer(byte_count);
+    ERR_FAIL_COND_V_MSG(bytes.size() != byte_count, nullptr,
+                        "CurveDataFile: '" + file_path + "' is truncated.");
+    const PackedFloat32Array data = bytes.to_float32_array();
+    const float *read = data.ptr();
+
+    CachedChunk &chunk = cache[slot];
+    chunk.index = p_chunk;
+    chunk.last_use = use_counter;
+    chunk.points = Points();
+    auto read_vectors = [&](PackedVector3Array &r_vectors)
+    {
+        r_vectors.resize(info.count);
+        Vector3 *write = r_vectors.ptrw();
+        for (int i = 0; i < info.count; i++)
+        {
+            write[i] = Vector3(read[0], read[1], read[2]);
+            read += 3;
+        }
+    };
+    auto read_floats = [&](PackedFloat32Array &r_floats)
+    {
+        r_floats.resize(info.count);
+        memcpy(r_floats.ptrw(), read, info.count * sizeof(float));
+        read += info.count;
+    };
+
+    read_vectors(chunk.points.positions);
+    if (file_handles)
+    {
+        read_vectors(chunk.points.in_handles);
+        read_vectors(chunk.points.out_handles);
+    }
+    if (file_tilts)
+    {
+        read_floats(chunk.points.tilts);
+    }
+    if (file_widths)
+    {
+        read_floats(chunk.points.widths);
+    }
+    return &chunk.points;
+}
+
+float CurveDataFile::_get_point_distance(int64_t p_index) const
+{
+    // Chunk distances are exact at the first point of each chunk. Points in
+    // between are taken as evenly spaced, so no point data is read.
+    const int64_t index = CLAMP(p_index, (int64_t)0, point_count - 1);
+    const int c = Math::min((int)(index / chunk_size), (int)chunks.size() - 1);
+    const ChunkInfo &chunk = chunks[c];
+    float next_distance = length;
+    int64_t steps = (flags & FLAG_CLOSED) ? chunk.count : chunk.count - 1;
+    if (c + 1 < (int)chunks.size())
+    {
+        next_distance = chunks[c + 1].distance;
+        steps = chunk.count;
+    }
+    if (steps <= 0)
+    {
+        return chunk.distance;
+    }
+    return chunk.distance + (next_distance - chunk.distance) *
+                                (float)(index - chunk.begin) / steps;
+}
+
+float CurveDataFile::get_range_length(int64_t p_begin, int64_t p_count) const
+{
+    if (chunks.is_empty() || chunk_size <= 0)
+    {
+        return 0.0f;
+    }
+
+    const int64_t begin = CLAMP(p_begin, (int64_t)0, point_count);
+    const int64_t end = (p_count > 0)
+                            ? Math::min(begin + p_count, point_count)
+                            : point_count;
+    if (end - begin <= 1)
+    {
+        return 0.0f;
+    }
+    if (begin == 0 && end == point_count)
+    {
+        return length;
+    }
+    return _get_point_distance(end - 1) - _get_point_distance(begin);
+}
+
+bool CurveDataFile::read_range(int64_t p_begin, int64_t p_count,
+                               Points &r_points)
+{
+    r_points = Points();
+    if (file.is_null() || chunk_size <= 0)
+    {
+        return false;
+    }
+
+    const int64_t begin = CLAMP(p_begin, (int64_t)0, point_count);
+    const int64_t end = (p_count > 0)
+                            ? Math::min(begin + p_count, point_count)
+                            : point_count;
+    const int64_t count = end - begin;
+    if (count <= 0)
+    {
+        return false;
+    }
+
+    const bool file_handles = flags & FLAG_HANDLES;
+    const bool file_tilts = flags & FLAG_TILTS;
+    const bool file_widths = flags & FLAG_WIDTHS;
+    r_points.positions.resize(count);
+    if (file_handles)
+    {
+        r_points.in_handles.resize(count);
+        r_points.out_handles.resize(count);
+    }
+    if (file_tilts)
+    {
+        r_points.tilts.resize(count);
+    }
+    if (file_widths)
+    {
+        r_points.widths.resize(count);
+    }
+
+    // Only the chunks overlapping the range are read.
+    for (int64_t c = begin / chunk_size; c <= (end - 1) / chunk_size; c++)
+    {
+        const Points *chunk = _get_chunk(c);
+        if (chunk == nullptr)
+        {
+            r_points = Points();
+            return false;
+        }
+
+        const int64_t chunk_begin = chunks[c].begin;
+        const int64_t from = Math::max(begin, chunk_begin);
+        const int64_t to = Math::min(end, chunk_begin + chunks[c].count);
+        const int64_t length = to - from;
+        const int64_t source = from - chunk_begin;
+        const int64_t target = from - begin;
+
+        memcpy(r_points.positions.ptrw() + target,
+               chunk->positions.ptr() + source, length * sizeof(Vector3));
+        if (file_handles)
+        {
+            memcpy(r_points.in_handles.ptrw() + target,
+                   chunk->in_handles.ptr() + source, length * sizeof(Vector3));
+            memcpy(r_points.out_handles.ptrw() + target,
+                   chunk->out_handles.ptr() + source,
+                   length * sizeof(Vector3));
+        }
+        if (file_tilts)
+        {
+            memcpy(r_points.tilts.ptrw() + target, chunk->tilts.ptr() + source,
+                   length * sizeof(float));
+        }
+        if (file_widths)
+        {
+            memcpy(r_points.widths.ptrw() + target,
+                   chunk->widths.ptr() + source, length * sizeof(float));
+        }
+    }
+    return true;
+}
+
+Dictionary CurveDataFile::read_points(int64_t p_begin, int64_t p_count)
+{
+    Dictionary result;
+    Points points;
+    if (!read_range(p_begin, p_count, points))
+    {
+        return result;
+    }
+
+    result["positions"] = points.positions;
+    if (has_handles())
+    {
+        result["in_handles"] = points.in_handles;
+        result["out_handles"] = points.out_handles;
+    }
+    if (has_tilts())
+    {
+        result["tilts"] = points.tilts;
+    }
+    if (has_widths())
+    {
+        result["widths"] = points.widths;
+    }
+    return result;
+}
+
+void CurveDataFile::set_file_path(const String &p_path)
+{
+    file_path = p_path;
+    _open();
+    emit_changed();
+}
+
+String CurveDataFile::get_file_path() const { return file_path; }
+
+void CurveDataFile::set_cache_size(int p_chunks)
+{
+    cache_size = Math::max(p_chunks, 1);
+    if ((int)cache.size() > cache_size)
+    {
+        cache.clear();
+    }
+}
+
+int CurveDataFile::get_cache_size() const { return cache_size; }
+
+bool CurveDataFile::is_open() const { return file.is_valid(); }
+
+int64_t CurveDataFile::get_point_count() const { return point_count; }
+
+int CurveDataFile::get_chunk_count() const { return chunks.size(); }
+
+Vector2i CurveDataFile::get_chunk_range(int p_chunk) const
+{
+    ERR_FAIL_INDEX_V(p_chunk, (int)chunks.size(), Vector2i());
+    return Vector2i(chunks[p_chunk].begin, chunks[p_chunk].count);
+}
+
+AABB CurveDataFile::get_chunk_aabb(int p_chunk) const
+{
+    ERR_FAIL_INDEX_V(p_chunk, (int)chunks.size(), AABB());
+    return chunks[p_chunk].bounds;
+}
+
+float CurveDataFile::get_chunk_distance(int p_chunk) const
+{
+    ERR_FAIL_INDEX_V(p_chunk, (int)chunks.size(), 0.0f);
+    return chunks[p_chunk].distance;
+}
+
+AABB CurveDataFile::get_aabb() const { return bounds; }
+
+float CurveDataFile::get_length() const { return length; }
+
+bool CurveDataFile::has_handles() const { return flags & FLAG_HANDLES; }
+
+bool CurveDataFile::has_tilts() const { return flags & FLAG_TILTS; }
+
+bool CurveDataFile::has_widths() const { return flags & FLAG_WIDTHS; }
+
+bool CurveDataFile::is_closed() const { return flags & FLAG_CLOSED; }
+
+void CurveDataFile::_bind_methods()
+{
+    ClassDB::bind_static_method(
+        "CurveDataFile",
+        D_METHOD("save_points", "path", "positions", "tilts", "widths",
+                 "closed", "chunk_size"),
+        &CurveDataFile::save_points, DEFVAL(false), DEFVAL(4096));
+    ClassDB::bind_static_method(
+        "CurveDataFile",
+        D_METHOD("save_curve", "path", "curve", "widths", "chunk_size"),
+        &CurveDataFile::save_curve, DEFVAL(PackedFloat32Array()),
+        DEFVAL(4096));
+
+    ClassDB::bind_method(D_METHOD("read_points", "begin", "count"),
+                         &CurveDataFile::read_points);
+
+    ClassDB::bind_method(D_METHOD("set_file_path", "path"),
+                         &CurveDataFile::set_file_path);
+    ClassDB::bind_method(D_METHOD("get_file_path"),
+                         &CurveDataFile::get_file_path);
+    ClassDB::bind_method(D_METHOD("set_cache_size", "chunks"),
+                         &CurveDataFile::set_cache_size);
+    ClassDB::bind_method(D_METHOD("get_cache_size"),
+                         &CurveDataFile::get_cache_size);
+
+    ClassDB::bind_method(D_METHOD("is_open"), &CurveDataFile::is_open);
+    ClassDB::bind_method(D_METHOD("get_point_count"),
+                         &CurveDataFile::get_point_count);
+    ClassDB::bind_method(D_METHOD("get_chunk_count"),
+                         &CurveDataFile::get_chunk_count);
+    ClassDB::bind_method(D_METHOD("get_chunk_range", "chunk"),
+                         &CurveDataFile::get_chunk_range);
+    ClassDB::bind_method(D_METHOD("get_chunk_aabb", "chunk"),
+                         &CurveDataFile::get_chunk_aabb);
+    ClassDB::bind_method(D_METHOD("get_chunk_distance", "chunk"),
+                         &CurveDataFile::get_chunk_distance);
+    ClassDB::bind_method(D_METHOD("get_aabb"), &CurveDataFile::get_aabb);
+    ClassDB::bind_method(D_METHOD("get_length"), &CurveDataFile::get_length);
+    ClassDB::bind_method(D_METHOD("has_handles"),
+                         &CurveDataFile::has_handles);
+    ClassDB::bind_method(D_METHOD("has_tilts"), &CurveDataFile::has_tilts);
+    ClassDB::bind_method(D_METHOD("has_widths"), &CurveDataFile::has_widths);
+    ClassDB::bind_method(D_METHOD("is_closed"), &CurveDataFile::is_closed);
+
+    ADD_PROPERTY(PropertyInfo(Variant::STRING, "file_path",
+                              PROPERTY_HINT_FILE, "*.cmcv"),
+                 "set_file_path", "get_file_path");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "cache_size", PROPERTY_HINT_RANGE,
+                              "1,256,1,or_greater"),
+                 "set_cache_size", "get_cache_size");
+}
+
+} // namespace godot
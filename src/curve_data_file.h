@@ -0,0 +1,136 @@
+#ifndef CURVE_DATA_FILE_H
+#define CURVE_DATA_FILE_H
+
+#include <godot_cpp/classes/curve3d.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
+
+namespace godot
+{
+
+// Binary curve file that is read a chunk at a time. Opening a file only
+// reads its header and chunk index; point data is read when a range of
+// points is requested, and the most recently used chunks stay cached.
+//
+// Layout, little endian:
+//   header  "CMCV", version, flags, chunk size, point count, chunk count,
+//           length, bounds
+//   index   per chunk: data offset, point count, distance along the
+//           curve, bounds
+//   chunks  per chunk: positions, in and out handles, tilts, widths; the
+//           optional arrays only when the flags say so
+class CurveDataFile : public Resource
+{
+    GDCLASS(CurveDataFile, Resource);
+
+  public:
+    struct Points
+    {
+        PackedVector3Array positions;
+        PackedVector3Array in_handles;
+        PackedVector3Array out_handles;
+        PackedFloat32Array tilts;
+        PackedFloat32Array widths;
+    };
+
+  private:
+    enum Flags
+    {
+        FLAG_HANDLES = 1,
+        FLAG_TILTS = 2,
+        FLAG_WIDTHS = 4,
+        FLAG_CLOSED = 8,
+    };
+
+    struct ChunkInfo
+    {
+        uint64_t offset = 0;
+        int64_t begin = 0;
+        int count = 0;
+        float distance = 0.0f;
+        AABB bounds;
+    };
+
+    struct CachedChunk
+    {
+        int64_t index = -1;
+        uint64_t last_use = 0;
+        Points points;
+    };
+
+    String file_path;
+    int cache_size = 8;
+
+    Ref<FileAccess> file;
+    uint32_t flags = 0;
+    int chunk_size = 0;
+    int64_t point_count = 0;
+    float length = 0.0f;
+    AABB bounds;
+    LocalVector<ChunkInfo> chunks;
+    LocalVector<CachedChunk> cache;
+    uint64_t use_counter = 0;
+
+  private:
+    static Error _write(const String &p_path, const Points &p_points,
+                        bool p_closed, int p_chunk_size);
+
+    Error _open();
+    void _close();
+    const Points *_get_chunk(int64_t p_chunk);
+    float _get_point_distance(int64_t p_index) const;
+
+  protected:
+    static void _bind_methods();
+
+  public:
+    static const char *MAGIC;
+    static const uint32_t VERSION = 3;
+
+    static Error save_points(const String &p_path,
+                             const PackedVector3Array &p_positions,
+                             const PackedFloat32Array &p_tilts,
+                             const PackedFloat32Array &p_widths,
+                             bool p_closed = false, int p_chunk_size = 4096);
+    static Error save_curve(const String &p_path, const Ref<Curve3D> &p_curve,
+                            const PackedFloat32Array &p_widths =
+                                PackedFloat32Array(),
+                            int p_chunk_size = 4096);
+
+    bool read_range(int64_t p_begin, int64_t p_count, Points &r_points);
+    // Length of the points read_range() would return, taken from the chunk
+    // index alone. Exact for whole files and chunk boundaries.
+    float get_range_length(int64_t p_begin, int64_t p_count) const;
+    Dictionary read_points(int64_t p_begin, int64_t p_count);
+
+    void set_file_path(const String &p_path);
+    String get_file_path() const;
+
+    void set_cache_size(int p_chunks);
+    int get_cache_size() const;
+
+    bool is_open() const;
+    int64_t get_point_count() const;
+    int get_chunk_count() const;
+    Vector2i get_chunk_range(int p_chunk) const;
+    AABB get_chunk_aabb(int p_chunk) const;
+    float get_chunk_distance(int p_chunk) const;
+    AABB get_aabb() const;
+    float get_length() const;
+    bool has_handles() const;
+    bool has_tilts() const;
+    bool has_widths() const;
+    bool is_closed() const;
+};
+
+} // namespace godot
+
+#endif // CURVE_DATA_FILE_H
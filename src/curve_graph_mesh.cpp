@@ -0,0 +1,961 @@
+#include "curve_graph_mesh.h"
+
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+namespace godot
+{
+
+namespace
+{
+// Vertex of a junction patch ordered by its angle around the patch axis.
+struct PatchVertex
+{
+    float angle = 0.0f;
+    int index = -1;
+    Vector2 offset;
+
+    bool operator<(const PatchVertex &p_other) const
+    {
+        return angle < p_other.angle;
+    }
+};
+
+// UV2 chart ordered tallest first for packing.
+struct ChartOrder
+{
+    int height = 0;
+    uint32_t index = 0;
+
+    bool operator<(const ChartOrder &p_other) const
+    {
+        return height > p_other.height;
+    }
+};
+
+// Cuts p_start from the beginning and p_end from the end of a polyline,
+// measured along it. Leaves the polyline empty when nothing remains.
+static void _trim_polyline(PackedVector3Array &r_points,
+                           PackedFloat32Array &r_tilts, float p_start,
+                           float p_end)
+{
+    const int count = r_points.size();
+    if (count < 2 || (p_start <= 0.0f && p_end <= 0.0f))
+    {
+        return;
+    }
+
+    LocalVector<float> distances;
+    distances.resize(count);
+    distances[0] = 0.0f;
+    for (int i = 1; i < count; i++)
+    {
+        distances[i] =
+            distances[i - 1] + r_points[i].distance_to(r_points[i - 1]);
+    }
+
+    const float begin = p_start;
+    const float end = distances[count - 1] - p_end;
+    if (end - begin <= CMP_EPSILON)
+    {
+        r_points.clear();
+        r_tilts.clear();
+        return;
+    }
+
+    const bool has_tilts = r_tilts.size() == count;
+    auto sample = [&](float p_distance, Vector3 &r_position, float &r_tilt)
+    {
+        int i = 1;
+        while (i < count - 1 && distances[i] < p_distance)
+        {
+            i++;
+        }
+        const float length = distances[i] - distances[i - 1];
+        const float t =
+            (length > 0.0f) ? (p_distance - distances[i - 1]) / length : 0.0f;
+        r_position = r_points[i - 1].lerp(r_points[i], t);
+        r_tilt = has_tilts ? Math::lerp(r_tilts[i - 1], r_tilts[i], t) : 0.0f;
+    };
+
+    PackedVector3Array points;
+    PackedFloat32Array tilts;
+    Vector3 position;
+    float tilt = 0.0f;
+    sample(begin, position, tilt);
+    points.push_back(position);
+    tilts.push_back(tilt);
+    for (int i = 0; i < count; i++)
+    {
+        if (distances[i] > begin && distances[i] < end)
+        {
+            points.push_back(r_points[i]);
+            tilts.push_back(has_tilts ? r_tilts[i] : 0.0f);
+        }
+    }
+    sample(end, position, tilt);
+    points.push_back(position);
+    tilts.push_back(tilt);
+
+    r_points = points;
+    r_tilts = tilts;
+}
+
+static Vector3 _get_perpendicular(const Vector3 &p_axis)
+{
+    const Vector3 other = (Math::abs(p_axis.x) < 0.9f) ? Vector3(1, 0, 0)
+                                                       : Vector3(0, 0, 1);
+    return p_axis.cross(other).normalized();
+}
+} // namespace
+
+CurveGraphMesh::CurveGraphMesh() { set_edge_mesh(memnew(CurveMesh)); }
+
+CurveGraphMesh::~CurveGraphMesh() {}
+
+int CurveGraphMesh::_get_node_degree(int p_node) const
+{
+    int degree = 0;
+    for (const Edge &edge : edges)
+    {
+        degree += (edge.from == p_node) ? 1 : 0;
+        degree += (edge.to == p_node) ? 1 : 0;
+    }
+    return degree;
+}
+
+float CurveGraphMesh::_get_junction_radius() const
+{
+    if (junction_radius > 0.0f || edge_mesh.is_null())
+    {
+        return junction_radius;
+    }
+    // Two branches of this width meeting at a right angle no longer
+    // overlap once both are cut back by it.
+    return edge_mesh->get_width() * edge_mesh->get_profile_extent() * 2.0f;
+}
+
+Ref<Curve3D> CurveGraphMesh::_get_pinned_curve(const Edge &p_edge) const
+{
+    // The ends of an edge always sit on its nodes; the points in between
+    // are left to the curve. The curve may be shared with other resources,
+    // so a copy is moved rather than the curve itself.
+    const Ref<Curve3D> &curve = p_edge.curve;
+    const int count = curve->get_point_count();
+    if (count >= 2 && curve->get_point_position(0) == nodes[p_edge.from] &&
+        curve->get_point_position(count - 1) == nodes[p_edge.to])
+    {
+        return curve;
+    }
+
+    Ref<Curve3D> pinned = curve->duplicate();
+    while (pinned->get_point_count() < 2)
+    {
+        pinned->add_point(nodes[p_edge.to]);
+    }
+    pinned->set_point_position(0, nodes[p_edge.from]);
+    pinned->set_point_position(pinned->get_point_count() - 1,
+                               nodes[p_edge.to]);
+    return pinned;
+}
+
+void CurveGraphMesh::_connect_edge_curve(int p_edge)
+{
+    const Callable callable =
+        callable_mp(this, &CurveGraphMesh::_on_edge_curve_changed)
+            .bind(p_edge);
+    if (!edges[p_edge].curve->is_connected("changed", callable))
+    {
+        edges[p_edge].curve->connect("changed", callable);
+    }
+}
+
+void CurveGraphMesh::_disconnect_edge_curve(int p_edge)
+{
+    const Callable callable =
+        callable_mp(this, &CurveGraphMesh::_on_edge_curve_changed)
+            .bind(p_edge);
+    if (edges[p_edge].curve->is_connected("changed", callable))
+    {
+        edges[p_edge].curve->disconnect("changed", callable);
+    }
+}
+
+void CurveGraphMesh::_mark_node_edges_dirty(int p_node)
+{
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        if (edges[i].from == p_node || edges[i].to == p_node)
+        {
+            edge_caches[i].dirty = true;
+        }
+    }
+}
+
+void CurveGraphMesh::_mark_all_edges_dirty()
+{
+    for (EdgeCache &cache : edge_caches)
+    {
+        cache.dirty = true;
+    }
+}
+
+void CurveGraphMesh::_on_edge_curve_changed(int p_edge)
+{
+    ERR_FAIL_INDEX(p_edge, (int)edges.size());
+    edge_caches[p_edge].dirty = true;
+    request_update();
+}
+
+void CurveGraphMesh::_on_edge_mesh_changed()
+{
+    _mark_all_edges_dirty();
+    request_update();
+}
+
+void CurveGraphMesh::_prepare_edge(int p_edge) const
+{
+    const Edge &edge = edges[p_edge];
+    EdgeCache &cache = edge_caches[p_edge];
+    cache.build = CurveMesh::BackgroundBuild();
+    cache.dirty = false;
+
+    cache.build.settings = edge_mesh->get_build_settings();
+    cache.build.settings.tessellation_mode = CurveMesh::TESSELLATION_DISABLED;
+
+    // Edges are cut back at junctions to make room for the patch, so the
+    // branches do not overlap each other there.
+    const float radius = _get_junction_radius();
+    const float start_trim = (_get_node_degree(edge.from) > 2) ? radius : 0.0f;
+    const float end_trim = (_get_node_degree(edge.to) > 2) ? radius : 0.0f;
+
+    const Ref<Curve3D> curve = _get_pinned_curve(edge);
+    PackedVector3Array points = curve->get_baked_points();
+    PackedFloat32Array tilts = curve->get_baked_tilts();
+    if (tilts.size() != points.size())
+    {
+        tilts.clear();
+    }
+    _trim_polyline(points, tilts, start_trim, end_trim);
+
+    cache.length = 0.0f;
+    for (int64_t i = 1; i < points.size(); i++)
+    {
+        cache.length += points[i].distance_to(points[i - 1]);
+    }
+
+    cache.build.snapshot.point_positions = points;
+    cache.build.snapshot.point_tilts = tilts;
+    cache.build.snapshot.point_count = points.size();
+}
+
+void CurveGraphMesh::_build_edge_at(uint32_t p_index)
+{
+    EdgeCache &cache = edge_caches[building_edges[p_index]];
+    edge_mesh->run_build(cache.build);
+}
+
+void CurveGraphMesh::_update_edges() const
+{
+    edge_caches.resize(edges.size());
+    if (edge_mesh.is_null())
+    {
+        for (EdgeCache &cache : edge_caches)
+        {
+            cache = EdgeCache();
+            cache.dirty = false;
+        }
+        return;
+    }
+
+    building_edges.clear();
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        if (edge_caches[i].dirty)
+        {
+            _prepare_edge(i);
+            building_edges.push_back(i);
+        }
+    }
+
+    CurveGraphMesh *self = const_cast<CurveGraphMesh *>(this);
+    if (building_edges.size() > 1)
+    {
+        WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+        const int64_t task = pool->add_group_task(
+            callable_mp(self, &CurveGraphMesh::_build_edge_at),
+            building_edges.size(), -1, true, "CurveGraphMesh edges");
+        pool->wait_for_group_task_completion(task);
+    }
+    else if (building_edges.size() == 1)
+    {
+        self->_build_edge_at(0);
+    }
+    building_edges.clear();
+}
+
+void CurveGraphMesh::_weld_rings(SurfaceArrays &r_arrays,
+                                 const PackedInt32Array &p_a,
+                                 const PackedInt32Array &p_b) const
+{
+    // Both ends were generated from the same node position, so their rings
+    // only differ by the frame of each curve. Pairs are snapped together and
+    // share a normal; their UVs stay apart, as each edge has its own.
+    ERR_FAIL_COND_MSG(p_a.size() != p_b.size(),
+                      "CurveGraphMesh: cannot weld end rings of " +
+                          String::num_int64(p_a.size()) + " and " +
+                          String::num_int64(p_b.size()) + " vertices.");
+
+    Vector3 *points = r_arrays.points.ptrw();
+    Vector3 *normals = r_arrays.normals.ptrw();
+    for (int64_t i = 0; i < p_a.size(); i++)
+    {
+        const int a = p_a[i];
+        int b = p_b[0];
+        float best = Math_INF;
+        for (int64_t k = 0; k < p_b.size(); k++)
+        {
+            const float distance =
+                points[a].distance_squared_to(points[p_b[k]]);
+            if (distance < best)
+            {
+                best = distance;
+                b = p_b[k];
+            }
+        }
+
+        const Vector3 position = (points[a] + points[b]) * 0.5f;
+        const Vector3 normal = (normals[a] + normals[b]).normalized();
+        points[a] = position;
+        points[b] = position;
+        if (!normal.is_zero_approx())
+        {
+            normals[a] = normal;
+            normals[b] = normal;
+        }
+    }
+}
+
+void CurveGraphMesh::_add_junction_patch(
+    SurfaceArrays &r_arrays, const Vector3 &p_node,
+    const LocalVector<PackedInt32Array> &p_rings, bool p_add_uv2,
+    LocalVector<UV2Chart> &r_charts) const
+{
+    auto add_vertex = [&](const Vector3 &p_normal)
+    {
+        const Vector3 tangent = _get_perpendicular(p_normal);
+        r_arrays.points.push_back(p_node);
+        r_arrays.normals.push_back(p_normal);
+        r_arrays.tangents.push_back(tangent.x);
+        r_arrays.tangents.push_back(tangent.y);
+        r_arrays.tangents.push_back(tangent.z);
+        r_arrays.tangents.push_back(1.0f);
+        r_arrays.uvs.push_back(Vector2(0.0f, 0.5f));
+        if (p_add_uv2)
+        {
+            r_arrays.uv2s.push_back(Vector2(0.5f, 0.5f));
+        }
+        return (int)r_arrays.points.size() - 1;
+    };
+
+    auto copy_vertex = [&](int p_index, const Vector2 &p_uv2)
+    {
+        const Vector3 point = r_arrays.points[p_index];
+        const Vector3 normal = r_arrays.normals[p_index];
+        const Vector2 uv = r_arrays.uvs[p_index];
+        r_arrays.points.push_back(point);
+        r_arrays.normals.push_back(normal);
+        for (int k = 0; k < 4; k++)
+        {
+            const float tangent = r_arrays.tangents[p_index * 4 + k];
+            r_arrays.tangents.push_back(tangent);
+        }
+        r_arrays.uvs.push_back(uv);
+        r_arrays.uv2s.push_back(p_uv2);
+        return (int)r_arrays.points.size() - 1;
+    };
+
+    // With UV2, a patch gets its own copies of the ring vertices, laid out
+    // flat around the hub in a chart of its own, so it does not overlap the
+    // branches in the lightmap.
+    auto add_chart = [&](int p_hub, LocalVector<PatchVertex> &r_sorted)
+    {
+        if (!p_add_uv2)
+        {
+            return;
+        }
+
+        float radius = CMP_EPSILON;
+        for (const PatchVertex &vertex : r_sorted)
+        {
+            radius = Math::max(radius, (float)vertex.offset.length());
+        }
+        for (PatchVertex &vertex : r_sorted)
+        {
+            const Vector2 uv2 =
+                Vector2(0.5f, 0.5f) + vertex.offset / (radius * 2.0f);
+            vertex.index = copy_vertex(vertex.index, uv2);
+        }
+
+        UV2Chart chart;
+        chart.begin = p_hub;
+        chart.end = r_arrays.points.size();
+        chart.padding = edge_mesh->get_uv2_padding();
+        const float texel_size = CurveMesh::get_lightmap_texel_size();
+        const int size = (int)Math::ceil(
+            Math::max(1.0f, radius * 2.0f / texel_size) + 2.0f * chart.padding);
+        chart.size = Vector2i(size, size);
+        r_charts.push_back(chart);
+    };
+
+    // Godot's front faces wind clockwise, so (c - a) x (b - a) is the
+    // outward normal of a, b, c.
+    auto add_triangle = [&](int p_a, int p_b, int p_c, const Vector3 &p_out)
+    {
+        const Vector3 a = r_arrays.points[p_a];
+        const Vector3 face = (r_arrays.points[p_c] - a)
+                                 .cross(r_arrays.points[p_b] - a);
+        if (face.dot(p_out) < 0.0f)
+        {
+            SWAP(p_b, p_c);
+        }
+        r_arrays.indices.push_back(p_a);
+        r_arrays.indices.push_back(p_b);
+        r_arrays.indices.push_back(p_c);
+    };
+
+    auto sort_around = [&](const PackedInt32Array &p_ring,
+                           const Vector3 &p_center, const Vector3 &p_axis,
+                           LocalVector<PatchVertex> &r_sorted)
+    {
+        const Vector3 axis_x = _get_perpendicular(p_axis);
+        const Vector3 axis_y = p_axis.cross(axis_x);
+        for (int64_t i = 0; i < p_ring.size(); i++)
+        {
+            const Vector3 offset = r_arrays.points[p_ring[i]] - p_center;
+            PatchVertex vertex;
+            vertex.offset = Vector2(offset.dot(axis_x), offset.dot(axis_y));
+            vertex.angle = Math::atan2(vertex.offset.y, vertex.offset.x);
+            vertex.index = p_ring[i];
+            r_sorted.push_back(vertex);
+        }
+    };
+
+    if (edge_mesh->get_profile() == CurveMesh::PROFILE_FLAT)
+    {
+        // Ribbons lie in a common plane at the node: the ends of all
+        // branches are joined into one polygon around it.
+        Vector3 up;
+        PackedInt32Array ring;
+        for (const PackedInt32Array &branch : p_rings)
+        {
+            for (int64_t i = 0; i < branch.size(); i++)
+            {
+                up += r_arrays.normals[branch[i]];
+                ring.push_back(branch[i]);
+            }
+        }
+        up = up.is_zero_approx() ? Vector3(0, 1, 0) : up.normalized();
+
+        LocalVector<PatchVertex> sorted;
+        sort_around(ring, p_node, up, sorted);
+        sorted.sort();
+        if (sorted.size() < 2)
+        {
+            return;
+        }
+
+        const int hub = add_vertex(up);
+        add_chart(hub, sorted);
+        for (uint32_t i = 0; i < sorted.size(); i++)
+        {
+            const uint32_t next = (i + 1) % sorted.size();
+            add_triangle(hub, sorted[i].index, sorted[next].index, up);
+        }
+        return;
+    }
+
+    // Tubes and other profiles close each branch with a cone to the node,
+    // so the branches meet without gaps.
+    for (const PackedInt32Array &branch : p_rings)
+    {
+        if (branch.size() < 2)
+        {
+            continue;
+        }
+
+        Vector3 center;
+        for (int64_t i = 0; i < branch.size(); i++)
+        {
+            center += r_arrays.points[branch[i]];
+        }
+        center /= (float)branch.size();
+
+        const Vector3 axis = p_node - center;
+        if (axis.is_zero_approx())
+        {
+            continue;
+        }
+
+        LocalVector<PatchVertex> sorted;
+        sort_around(branch, center, axis.normalized(), sorted);
+        sorted.sort();
+
+        const int hub = add_vertex(axis.normalized());
+        add_chart(hub, sorted);
+        for (uint32_t i = 0; i < sorted.size(); i++)
+        {
+            const uint32_t next = (i + 1) % sorted.size();
+            const Vector3 out = r_arrays.points[sorted[i].index] +
+                                r_arrays.points[sorted[next].index] -
+                                center * 2.0f;
+            add_triangle(hub, sorted[i].index, sorted[next].index, out);
+        }
+    }
+}
+
+Vector2i CurveGraphMesh::_pack_uv2_charts(
+    SurfaceArrays &r_arrays, LocalVector<UV2Chart> &r_charts) const
+{
+    // Charts keep their size in texels and go on shelves, tallest first,
+    // in an atlas about as wide as it is tall.
+    int64_t area = 0;
+    int atlas_width = 1;
+    LocalVector<ChartOrder> order;
+    for (uint32_t i = 0; i < r_charts.size(); i++)
+    {
+        const Vector2i &size = r_charts[i].size;
+        area += (int64_t)size.x * size.y;
+        atlas_width = MAX(atlas_width, size.x);
+        ChartOrder entry;
+        entry.height = size.y;
+        entry.index = i;
+        order.push_back(entry);
+    }
+    atlas_width = MAX(atlas_width, (int)Math::ceil(Math::sqrt((double)area)));
+    order.sort();
+
+    Vector2i cursor;
+    int shelf_height = 0;
+    for (const ChartOrder &entry : order)
+    {
+        UV2Chart &chart = r_charts[entry.index];
+        if (cursor.x + chart.size.x > atlas_width)
+        {
+            cursor.x = 0;
+            cursor.y += shelf_height;
+            shelf_height = 0;
+        }
+        chart.position = cursor;
+        cursor.x += chart.size.x;
+        shelf_height = MAX(shelf_height, chart.size.y);
+    }
+    const Vector2i atlas(atlas_width, MAX(1, cursor.y + shelf_height));
+
+    const Vector2 atlas_size(atlas.x, atlas.y);
+    Vector2 *uv2_data = r_arrays.uv2s.ptrw();
+    for (const UV2Chart &chart : r_charts)
+    {
+        const Vector2 inner = Vector2(chart.size.x, chart.size.y) -
+                              Vector2(chart.padding, chart.padding) * 2.0f;
+        const Vector2 offset = Vector2(chart.position.x, chart.position.y) +
+                               Vector2(chart.padding, chart.padding);
+        for (int i = chart.begin; i < chart.end; i++)
+        {
+            uv2_data[i] = (offset + uv2_data[i] * inner) / atlas_size;
+        }
+    }
+    return atlas;
+}
+
+Array CurveGraphMesh::_create_mesh_array() const
+{
+    _update_edges();
+
+    SurfaceArrays arrays;
+    const bool add_uv2 = edge_mesh.is_valid() && edge_mesh->get_add_uv2();
+    LocalVector<UV2Chart> charts;
+
+    // Cached edges are copied in as they are; only their indices move.
+    LocalVector<int> base_vertices;
+    base_vertices.resize(edges.size());
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        const EdgeCache &cache = edge_caches[i];
+        base_vertices[i] = -1;
+        if (cache.build.stats.triangle_count == 0)
+        {
+            continue;
+        }
+
+        const Array &edge_arrays = cache.build.arrays;
+        const int base = arrays.points.size();
+        base_vertices[i] = base;
+
+        const PackedVector3Array points = edge_arrays[Mesh::ARRAY_VERTEX];
+        arrays.points.append_array(points);
+        arrays.normals.append_array(edge_arrays[Mesh::ARRAY_NORMAL]);
+        arrays.tangents.append_array(edge_arrays[Mesh::ARRAY_TANGENT]);
+        arrays.uvs.append_array(edge_arrays[Mesh::ARRAY_TEX_UV]);
+        if (add_uv2)
+        {
+            const PackedVector2Array uv2s = edge_arrays[Mesh::ARRAY_TEX_UV2];
+            if (uv2s.size() == points.size())
+            {
+                arrays.uv2s.append_array(uv2s);
+            }
+            else
+            {
+                arrays.uv2s.resize(arrays.points.size());
+            }
+
+            // The edge's UV2 already has its padding.
+            UV2Chart chart;
+            chart.begin = base;
+            chart.end = arrays.points.size();
+            chart.size = edge_mesh->get_lightmap_size(cache.length, false);
+            charts.push_back(chart);
+        }
+
+        const PackedInt32Array indices = edge_arrays[Mesh::ARRAY_INDEX];
+        const int index_begin = arrays.indices.size();
+        arrays.indices.append_array(indices);
+        int *index_data = arrays.indices.ptrw();
+        for (int64_t k = index_begin; k < arrays.indices.size(); k++)
+        {
+            index_data[k] += base;
+        }
+    }
+
+    for (uint32_t n = 0; n < nodes.size(); n++)
+    {
+        LocalVector<PackedInt32Array> rings;
+        for (uint32_t i = 0; i < edges.size(); i++)
+        {
+            if (base_vertices[i] < 0)
+            {
+                continue;
+            }
+            for (int end = 0; end < 2; end++)
+            {
+                const int node = (end == 0) ? edges[i].from : edges[i].to;
+                const PackedInt32Array &end_ring =
+                    edge_caches[i].build.end_rings[end];
+                if (node != (int)n || end_ring.is_empty())
+                {
+                    continue;
+                }
+                PackedInt32Array ring = end_ring;
+                int *ring_data = ring.ptrw();
+                for (int64_t k = 0; k < ring.size(); k++)
+                {
+                    ring_data[k] += base_vertices[i];
+                }
+                rings.push_back(ring);
+            }
+        }
+
+        const int degree = _get_node_degree(n);
+        if (degree == 2 && rings.size() == 2)
+        {
+            _weld_rings(arrays, rings[0], rings[1]);
+        }
+        else if (degree > 2 && !rings.is_empty())
+        {
+            _add_junction_patch(arrays, nodes[n], rings, add_uv2, charts);
+        }
+    }
+
+    if (!charts.is_empty())
+    {
+        const Vector2i lightmap_size_hint = _pack_uv2_charts(arrays, charts);
+        const_cast<CurveGraphMesh *>(this)->set_lightmap_size_hint(
+            lightmap_size_hint);
+    }
+
+    if (arrays.indices.is_empty())
+    {
+        // PrimitiveMesh needs at least one triangle.
+        arrays = SurfaceArrays();
+        arrays.points.push_back(Vector3());
+        arrays.normals.push_back(Vector3(0.0, 1.0, 0.0));
+        arrays.uvs.push_back(Vector2());
+        if (add_uv2)
+        {
+            arrays.uv2s.push_back(Vector2());
+        }
+        arrays.tangents.push_back(1.0f);
+        arrays.tangents.push_back(0.0f);
+        arrays.tangents.push_back(0.0f);
+        arrays.tangents.push_back(1.0f);
+        arrays.indices.push_back(0);
+        arrays.indices.push_back(0);
+        arrays.indices.push_back(0);
+    }
+
+    Array arr;
+    arr.resize(Mesh::ARRAY_MAX);
+    arr[Mesh::ARRAY_VERTEX] = arrays.points;
+    arr[Mesh::ARRAY_NORMAL] = arrays.normals;
+    arr[Mesh::ARRAY_TANGENT] = arrays.tangents;
+    arr[Mesh::ARRAY_TEX_UV] = arrays.uvs;
+    if (add_uv2)
+    {
+        arr[Mesh::ARRAY_TEX_UV2] = arrays.uv2s;
+    }
+    arr[Mesh::ARRAY_INDEX] = arrays.indices;
+    return arr;
+}
+
+int CurveGraphMesh::add_node(const Vector3 &p_position)
+{
+    nodes.push_back(p_position);
+    return nodes.size() - 1;
+}
+
+void CurveGraphMesh::set_node_position(int p_node, const Vector3 &p_position)
+{
+    ERR_FAIL_INDEX(p_node, (int)nodes.size());
+    if (nodes[p_node] == p_position)
+    {
+        return;
+    }
+
+    nodes[p_node] = p_position;
+    _mark_node_edges_dirty(p_node);
+    request_update();
+}
+
+Vector3 CurveGraphMesh::get_node_position(int p_node) const
+{
+    ERR_FAIL_INDEX_V(p_node, (int)nodes.size(), Vector3());
+    return nodes[p_node];
+}
+
+int CurveGraphMesh::get_node_count() const { return nodes.size(); }
+
+PackedInt32Array CurveGraphMesh::get_node_edges(int p_node) const
+{
+    PackedInt32Array node_edges;
+    ERR_FAIL_INDEX_V(p_node, (int)nodes.size(), node_edges);
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        if (edges[i].from == p_node || edges[i].to == p_node)
+        {
+            node_edges.push_back(i);
+        }
+    }
+    return node_edges;
+}
+
+int CurveGraphMesh::add_edge(int p_from, int p_to, const Ref<Curve3D> &p_curve)
+{
+    ERR_FAIL_INDEX_V(p_from, (int)nodes.size(), -1);
+    ERR_FAIL_INDEX_V(p_to, (int)nodes.size(), -1);
+
+    Edge edge;
+    edge.from = p_from;
+    edge.to = p_to;
+    edge.curve = p_curve;
+    if (edge.curve.is_null())
+    {
+        edge.curve.instantiate();
+        edge.curve->add_point(nodes[p_from]);
+        edge.curve->add_point(nodes[p_to]);
+    }
+
+    edges.push_back(edge);
+    edge_caches.resize(edges.size());
+    const int index = edges.size() - 1;
+    _connect_edge_curve(index);
+
+    // A new edge changes the degree of both nodes, which decides whether
+    // the other edges ending there are cut back for a junction.
+    _mark_node_edges_dirty(p_from);
+    _mark_node_edges_dirty(p_to);
+    request_update();
+    return index;
+}
+
+Vector2i CurveGraphMesh::get_edge_nodes(int p_edge) const
+{
+    ERR_FAIL_INDEX_V(p_edge, (int)edges.size(), Vector2i(-1, -1));
+    return Vector2i(edges[p_edge].from, edges[p_edge].to);
+}
+
+Ref<Curve3D> CurveGraphMesh::get_edge_curve(int p_edge) const
+{
+    ERR_FAIL_INDEX_V(p_edge, (int)edges.size(), Ref<Curve3D>());
+    return edges[p_edge].curve;
+}
+
+int CurveGraphMesh::get_edge_count() const { return edges.size(); }
+
+void CurveGraphMesh::clear()
+{
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        _disconnect_edge_curve(i);
+    }
+    edges.clear();
+    edge_caches.clear();
+    nodes.clear();
+    request_update();
+}
+
+void CurveGraphMesh::set_edge_mesh(const Ref<CurveMesh> &p_mesh)
+{
+    if (edge_mesh == p_mesh)
+    {
+        return;
+    }
+
+    const Callable callable =
+        callable_mp(this, &CurveGraphMesh::_on_edge_mesh_changed);
+    if (edge_mesh.is_valid())
+    {
+        edge_mesh->disconnect("changed", callable);
+    }
+
+    edge_mesh = p_mesh;
+
+    if (edge_mesh.is_valid())
+    {
+        edge_mesh->connect("changed", callable);
+    }
+
+    _mark_all_edges_dirty();
+    request_update();
+}
+
+Ref<CurveMesh> CurveGraphMesh::get_edge_mesh() const { return edge_mesh; }
+
+void CurveGraphMesh::set_junction_radius(float p_radius)
+{
+    p_radius = Math::max(p_radius, 0.0f);
+    if (junction_radius != p_radius)
+    {
+        junction_radius = p_radius;
+        _mark_all_edges_dirty();
+        request_update();
+    }
+}
+
+float CurveGraphMesh::get_junction_radius() const { return junction_radius; }
+
+void CurveGraphMesh::set_node_positions(const PackedVector3Array &p_positions)
+{
+    ERR_FAIL_COND_MSG(!edges.is_empty() && p_positions.size() < nodes.size(),
+                      "Cannot remove nodes that edges still use.");
+
+    nodes.resize(p_positions.size());
+    for (int64_t i = 0; i < p_positions.size(); i++)
+    {
+        set_node_position(i, p_positions[i]);
+    }
+    request_update();
+}
+
+PackedVector3Array CurveGraphMesh::get_node_positions() const
+{
+    PackedVector3Array positions;
+    for (const Vector3 &position : nodes)
+    {
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+void CurveGraphMesh::set_edges(const Array &p_edges)
+{
+    for (uint32_t i = 0; i < edges.size(); i++)
+    {
+        _disconnect_edge_curve(i);
+    }
+    edges.clear();
+    edge_caches.clear();
+
+    for (int64_t i = 0; i < p_edges.size(); i++)
+    {
+        const Dictionary edge = p_edges[i];
+        add_edge(edge.get("from", -1), edge.get("to", -1),
+                 edge.get("curve", Ref<Curve3D>()));
+    }
+    request_update();
+}
+
+Array CurveGraphMesh::get_edges() const
+{
+    Array result;
+    for (const Edge &edge : edges)
+    {
+        Dictionary entry;
+        entry["from"] = edge.from;
+        entry["to"] = edge.to;
+        entry["curve"] = edge.curve;
+        result.push_back(entry);
+    }
+    return result;
+}
+
+void CurveGraphMesh::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("add_node", "position"),
+                         &CurveGraphMesh::add_node);
+    ClassDB::bind_method(D_METHOD("set_node_position", "node", "position"),
+                         &CurveGraphMesh::set_node_position);
+    ClassDB::bind_method(D_METHOD("get_node_position", "node"),
+                         &CurveGraphMesh::get_node_position);
+    ClassDB::bind_method(D_METHOD("get_node_count"),
+                         &CurveGraphMesh::get_node_count);
+    ClassDB::bind_method(D_METHOD("get_node_edges", "node"),
+                         &CurveGraphMesh::get_node_edges);
+
+    ClassDB::bind_method(D_METHOD("add_edge", "from", "to", "curve"),
+                         &CurveGraphMesh::add_edge, DEFVAL(Ref<Curve3D>()));
+    ClassDB::bind_method(D_METHOD("get_edge_nodes", "edge"),
+                         &CurveGraphMesh::get_edge_nodes);
+    ClassDB::bind_method(D_METHOD("get_edge_curve", "edge"),
+                         &CurveGraphMesh::get_edge_curve);
+    ClassDB::bind_method(D_METHOD("get_edge_count"),
+                         &CurveGraphMesh::get_edge_count);
+
+    ClassDB::bind_method(D_METHOD("clear"), &CurveGraphMesh::clear);
+
+    ClassDB::bind_method(D_METHOD("set_edge_mesh", "mesh"),
+                         &CurveGraphMesh::set_edge_mesh);
+    ClassDB::bind_method(D_METHOD("get_edge_mesh"),
+                         &CurveGraphMesh::get_edge_mesh);
+    ClassDB::bind_method(D_METHOD("set_junction_radius", "radius"),
+                         &CurveGraphMesh::set_junction_radius);
+    ClassDB::bind_method(D_METHOD("get_junction_radius"),
+                         &CurveGraphMesh::get_junction_radius);
+    ClassDB::bind_method(D_METHOD("set_node_positions", "positions"),
+                         &CurveGraphMesh::set_node_positions);
+    ClassDB::bind_method(D_METHOD("get_node_positions"),
+                         &CurveGraphMesh::get_node_positions);
+    ClassDB::bind_method(D_METHOD("set_edges", "edges"),
+                         &CurveGraphMesh::set_edges);
+    ClassDB::bind_method(D_METHOD("get_edges"), &CurveGraphMesh::get_edges);
+
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "edge_mesh",
+                              PROPERTY_HINT_RESOURCE_TYPE, "CurveMesh"),
+                 "set_edge_mesh", "get_edge_mesh");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "junction_radius",
+                              PROPERTY_HINT_RANGE, "0,100,0.01,or_greater"),
+                 "set_junction_radius", "get_junction_radius");
+    // Nodes come first, so the edges find them when a scene is loaded.
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "node_positions",
+                              PROPERTY_HINT_NONE, "",
+                              PROPERTY_USAGE_NO_EDITOR),
+                 "set_node_positions", "get_node_positions");
+    ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "edges", PROPERTY_HINT_NONE, "",
+                              PROPERTY_USAGE_NO_EDITOR),
+                 "set_edges", "get_edges");
+}
+
+} // namespace godot
@@ -0,0 +1,140 @@
+#ifndef CURVE_GRAPH_MESH_H
+#define CURVE_GRAPH_MESH_H
+
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/curve3d.hpp>
+#include <godot_cpp/classes/primitive_mesh.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+namespace godot
+{
+
+// Network of Curve3D edges meeting at shared nodes, such as roads or pipes,
+// generated into a single surface with the settings of one CurveMesh. Each
+// edge keeps its generated arrays, so moving a node only rebuilds the edges
+// that end at it. Ends meeting at a node of two edges are welded, and nodes
+// of three or more edges get a junction patch.
+class CurveGraphMesh : public PrimitiveMesh
+{
+    GDCLASS(CurveGraphMesh, PrimitiveMesh);
+
+  private:
+    struct Edge
+    {
+        int from = -1;
+        int to = -1;
+        Ref<Curve3D> curve;
+    };
+
+    // Generated arrays of one edge. The end rings of the build are what
+    // welds and junction patches connect to.
+    struct EdgeCache
+    {
+        CurveMesh::BackgroundBuild build;
+        float length = 0.0f;
+        bool dirty = true;
+    };
+
+    // Vertices [begin, end) whose UV2 fills a rect of size texels,
+    // padding included, and which is placed at position in the atlas.
+    struct UV2Chart
+    {
+        int begin = 0;
+        int end = 0;
+        Vector2i size;
+        float padding = 0.0f;
+        Vector2i position;
+    };
+
+    // Surface arrays of the whole graph while it is assembled.
+    struct SurfaceArrays
+    {
+        PackedVector3Array points;
+        PackedVector3Array normals;
+        PackedFloat32Array tangents;
+        PackedVector2Array uvs;
+        PackedVector2Array uv2s;
+        PackedInt32Array indices;
+    };
+
+    Ref<CurveMesh> edge_mesh;
+    float junction_radius = 0.0f;
+
+    LocalVector<Vector3> nodes;
+    LocalVector<Edge> edges;
+
+    mutable LocalVector<EdgeCache> edge_caches;
+    mutable LocalVector<uint32_t> building_edges;
+
+  private:
+    int _get_node_degree(int p_node) const;
+    float _get_junction_radius() const;
+    Ref<Curve3D> _get_pinned_curve(const Edge &p_edge) const;
+    void _connect_edge_curve(int p_edge);
+    void _disconnect_edge_curve(int p_edge);
+    void _mark_node_edges_dirty(int p_node);
+    void _mark_all_edges_dirty();
+    void _on_edge_curve_changed(int p_edge);
+    void _on_edge_mesh_changed();
+
+    void _prepare_edge(int p_edge) const;
+    void _build_edge_at(uint32_t p_index);
+    void _update_edges() const;
+
+    void _weld_rings(SurfaceArrays &r_arrays, const PackedInt32Array &p_a,
+                     const PackedInt32Array &p_b) const;
+    void _add_junction_patch(SurfaceArrays &r_arrays, const Vector3 &p_node,
+                             const LocalVector<PackedInt32Array> &p_rings,
+                             bool p_add_uv2,
+                             LocalVector<UV2Chart> &r_charts) const;
+    Vector2i _pack_uv2_charts(SurfaceArrays &r_arrays,
+                              LocalVector<UV2Chart> &r_charts) const;
+
+  protected:
+    static void _bind_methods();
+
+  public:
+    Array _create_mesh_array() const override;
+
+    int add_node(const Vector3 &p_position);
+    void set_node_position(int p_node, const Vector3 &p_position);
+    Vector3 get_node_position(int p_node) const;
+    int get_node_count() const;
+    PackedInt32Array get_node_edges(int p_node) const;
+
+    int add_edge(int p_from, int p_to,
+                 const Ref<Curve3D> &p_curve = Ref<Curve3D>());
+    Vector2i get_edge_nodes(int p_edge) const;
+    Ref<Curve3D> get_edge_curve(int p_edge) const;
+    int get_edge_count() const;
+
+    void clear();
+
+    void set_edge_mesh(const Ref<CurveMesh> &p_mesh);
+    Ref<CurveMesh> get_edge_mesh() const;
+
+    void set_junction_radius(float p_radius);
+    float get_junction_radius() const;
+
+    void set_node_positions(const PackedVector3Array &p_positions);
+    PackedVector3Array get_node_positions() const;
+
+    void set_edges(const Array &p_edges);
+    Array get_edges() const;
+
+    CurveGraphMesh();
+    ~CurveGraphMesh();
+};
+
+} // namespace godot
+
+#endif // CURVE_GRAPH_MESH_H
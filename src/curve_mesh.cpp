@@ -1,20 +1,34 @@
 #include "curve_mesh.h"
+#include "curve_mesh_profiler.h"
+#include "curve_mesh_scheduler.h"
+#include "vertex_cache_optimizer.h"
 
 #include <godot_cpp/classes/global_constants.hpp>
+#include <godot_cpp/classes/material.hpp>
 #include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/scene_tree_timer.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/math.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/array.hpp>
 #include <godot_cpp/variant/callable.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
 #include <godot_cpp/variant/packed_int32_array.hpp>
 #include <godot_cpp/variant/packed_vector2_array.hpp>
 #include <godot_cpp/variant/packed_vector3_array.hpp>
 #include <godot_cpp/variant/string_name.hpp>
 #include <godot_cpp/variant/variant.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+
+#include <array>
 
 namespace godot
 {
@@ -43,6 +57,41 @@ static float _get_project_texel_size()
     return _clamp_positive((float)value, 0.2f);
 }
 
+// Midpoints are added in parameter order by recursing into the first half
+// before adding the midpoint.
+static void _tessellate_segment(LocalVector<Vector3> &r_points,
+                                const Vector3 &a, const Vector3 &control_a,
+                                const Vector3 &control_b, const Vector3 &b,
+                                real_t begin, real_t end, int depth,
+                                int max_depth, float tolerance_cos)
+{
+    const real_t mid = begin + (end - begin) * 0.5f;
+    const Vector3 begin_position =
+        a.bezier_interpolate(control_a, control_b, b, begin);
+    const Vector3 mid_position =
+        a.bezier_interpolate(control_a, control_b, b, mid);
+    const Vector3 end_position =
+        a.bezier_interpolate(control_a, control_b, b, end);
+
+    const Vector3 na = (mid_position - begin_position).normalized();
+    const Vector3 nb = (end_position - mid_position).normalized();
+
+    if (depth < max_depth)
+    {
+        _tessellate_segment(r_points, a, control_a, control_b, b, begin, mid,
+                            depth + 1, max_depth, tolerance_cos);
+    }
+    if (na.dot(nb) < tolerance_cos)
+    {
+        r_points.push_back(mid_position);
+    }
+    if (depth < max_depth)
+    {
+        _tessellate_segment(r_points, a, control_a, control_b, b, mid, end,
+                            depth + 1, max_depth, tolerance_cos);
+    }
+}
+
 static float _get_width_curve_value(const Ref<Curve> &width_curve, float t,
                                     float default_value)
 {
@@ -52,23 +101,298 @@ static float _get_width_curve_value(const Ref<Curve> &width_curve, float t,
     }
     return width_curve->sample(t);
 }
+
+// Bones are spread evenly over the length of the curve. On a closed curve
+// the last bone is followed by the first one again.
+static float _get_bone_offset(int bone, int bone_count, bool closed)
+{
+    if (bone_count <= 1)
+    {
+        return 0.0f;
+    }
+    return (float)bone / (closed ? bone_count : bone_count - 1);
+}
+
+static void _add_skin_weights(float offset, int bone_count, bool closed,
+                              PackedInt32Array &bones,
+                              PackedFloat32Array &weights)
+{
+    int bone_a = 0;
+    int bone_b = 0;
+    float blend = 0.0f;
+    if (bone_count > 1)
+    {
+        const float span =
+            Math::clamp(offset, 0.0f, 1.0f) *
+            (closed ? bone_count : bone_count - 1);
+        bone_a = Math::min((int)span, closed ? bone_count : bone_count - 2);
+        blend = span - bone_a;
+        bone_a %= bone_count;
+        bone_b = (bone_a + 1) % bone_count;
+    }
+
+    bones.push_back(bone_a);
+    bones.push_back(bone_b);
+    bones.push_back(0);
+    bones.push_back(0);
+    weights.push_back(1.0f - blend);
+    weights.push_back(blend);
+    weights.push_back(0.0f);
+    weights.push_back(0.0f);
+}
+
+static void _push_unorm16(PackedByteArray &bytes, float value)
+{
+    const uint32_t quantized =
+        (uint32_t)Math::round(Math::clamp(value, 0.0f, 1.0f) * 65535.0f);
+    bytes.push_back(quantized & 0xff);
+    bytes.push_back(quantized >> 8);
+}
+
+// CUSTOM0 holds the normalized arc length as 16-bit fixed point and the
+// distance from the centerline as a half float. CUSTOM1 holds the direction
+// from the centerline, octahedral encoded with 16 bits per component. Both
+// use the default RGBA8 unorm format, decoded by curve_mesh.gdshaderinc.
+static void _add_shader_channels(float offset, const Vector3 &spoke,
+                                 const Vector3 &fallback_direction,
+                                 PackedByteArray &custom0,
+                                 PackedByteArray &custom1)
+{
+    const float radius = spoke.length();
+    Vector3 direction = radius > CMP_EPSILON ? spoke / radius
+                                             : fallback_direction;
+
+    _push_unorm16(custom0, offset);
+    const uint16_t half_radius = Math::make_half_float(radius);
+    custom0.push_back(half_radius & 0xff);
+    custom0.push_back(half_radius >> 8);
+
+    direction /= Math::abs(direction.x) + Math::abs(direction.y) +
+                 Math::abs(direction.z);
+    Vector2 octahedral(direction.x, direction.y);
+    if (direction.z < 0.0f)
+    {
+        octahedral = Vector2(
+            (1.0f - Math::abs(direction.y)) * (direction.x >= 0.0f ? 1 : -1),
+            (1.0f - Math::abs(direction.x)) * (direction.y >= 0.0f ? 1 : -1));
+    }
+    _push_unorm16(custom1, octahedral.x * 0.5f + 0.5f);
+    _push_unorm16(custom1, octahedral.y * 0.5f + 0.5f);
+}
+
+// Moves the rows of the vertices that survive culling to their remapped
+// slots. Arrays of disabled channels are empty and left alone.
+template <typename T>
+static void _compact_vertex_array(T &array, const LocalVector<int> &remap,
+                                  int vertex_count, int kept)
+{
+    const int stride = array.size() / vertex_count;
+    if (stride == 0)
+    {
+        return;
+    }
+    for (int v = 0; v < vertex_count; v++)
+    {
+        const int target = remap[v];
+        if (target < 0 || target == v)
+        {
+            continue;
+        }
+        for (int t = 0; t < stride; t++)
+        {
+            array.set(target * stride + t, array[v * stride + t]);
+        }
+    }
+    array.resize(kept * stride);
+}
 } // namespace
 
 CurveMesh::CurveMesh() {}
 
+CurveMesh::~CurveMesh() { _wait_for_refinement(); }
+
+int CurveMesh::_get_edge_count(Profile profile) const
+{
+    return (profile == PROFILE_TUBE || profile == PROFILE_CUSTOM) ? 1 : 2;
+}
+
+void CurveMesh::_update_profile_template()
+{
+    _wait_for_refinement();
+
+    profile_template.positions.clear();
+    profile_template.normals.clear();
+    profile_template.v.clear();
+    profile_template.connect_next.clear();
+    profile_template.length = 0.0f;
+
+    const int count = profile_shape.size();
+    if (count < 2)
+    {
+        return;
+    }
+
+    // Rings are stamped clockwise in the (binormal, up) plane, like the
+    // tube profile, so counter-clockwise closed shapes are walked backwards
+    // to keep their faces pointing outwards.
+    bool reverse = false;
+    if (profile_closed)
+    {
+        float signed_area = 0.0f;
+        for (int i = 0; i < count; i++)
+        {
+            signed_area +=
+                profile_shape[i].cross(profile_shape[(i + 1) % count]);
+        }
+        reverse = signed_area > 0.0f;
+    }
+
+    LocalVector<Vector2> shape;
+    LocalVector<uint8_t> hard;
+    shape.resize(count);
+    hard.resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        shape[i] = profile_shape[reverse ? count - 1 - i : i];
+        hard[i] = 0;
+    }
+    for (int i = 0; i < profile_hard_corners.size(); i++)
+    {
+        const int corner = profile_hard_corners[i];
+        if (corner >= 0 && corner < count)
+        {
+            hard[reverse ? count - 1 - corner : corner] = 1;
+        }
+    }
+
+    const int segment_count = profile_closed ? count : count - 1;
+    LocalVector<Vector2> segment_normals;
+    LocalVector<float> segment_lengths;
+    segment_normals.resize(segment_count);
+    segment_lengths.resize(segment_count);
+    for (int i = 0; i < segment_count; i++)
+    {
+        const Vector2 dir = shape[(i + 1) % count] - shape[i];
+        segment_lengths[i] = dir.length();
+        segment_normals[i] = Vector2(-dir.y, dir.x).normalized();
+        profile_template.length += segment_lengths[i];
+    }
+
+    auto push_vertex = [this](const Vector2 &p_position,
+                              const Vector2 &p_normal, float p_v,
+                              bool p_connect_next)
+    {
+        profile_template.positions.push_back(p_position);
+        profile_template.normals.push_back(p_normal);
+        profile_template.v.push_back(p_v);
+        profile_template.connect_next.push_back(p_connect_next);
+    };
+
+    // Closed profiles repeat their first vertex at the end, so the V
+    // coordinate can run from 0 to 1 without wrapping back mid-face.
+    float distance = 0.0f;
+    for (int i = 0; i <= segment_count; i++)
+    {
+        const int vertex = i % count;
+        const Vector2 &position = shape[vertex];
+        const float v = profile_template.length > 0.0f
+                            ? distance / profile_template.length
+                            : 0.0f;
+
+        const bool has_in = i > 0 || profile_closed;
+        const bool has_out = i < segment_count || profile_closed;
+        const Vector2 in_normal =
+            has_in ? segment_normals[(i + segment_count - 1) % segment_count]
+                   : Vector2();
+        const Vector2 out_normal =
+            has_out ? segment_normals[i % segment_count] : Vector2();
+
+        if (!has_in || !has_out)
+        {
+            push_vertex(position, has_in ? in_normal : out_normal, v,
+                        i < segment_count);
+        }
+        else if (hard[vertex])
+        {
+            if (i > 0)
+            {
+                push_vertex(position, in_normal, v, false);
+            }
+            if (i < segment_count)
+            {
+                push_vertex(position, out_normal, v, true);
+            }
+        }
+        else
+        {
+            Vector2 normal = (in_normal + out_normal).normalized();
+            if (normal.is_zero_approx())
+            {
+                normal = out_normal;
+            }
+            push_vertex(position, normal, v, i < segment_count);
+        }
+
+        if (i < segment_count)
+        {
+            distance += segment_lengths[i];
+        }
+    }
+}
+
 void CurveMesh::_update_lightmap_size()
 {
-    if (!get_add_uv2() || curve.is_null() || curve->get_point_count() <= 1)
+    if (!get_add_uv2())
     {
         return;
     }
 
+    float lightmap_length = 0.0f;
+    bool closed = false;
+    if (use_direct_points)
+    {
+        const int point_count = point_positions.size();
+        if (point_count <= 1)
+        {
+            return;
+        }
+        const Vector3 *positions = point_positions.ptr();
+        for (int i = 1; i < point_count; i++)
+        {
+            lightmap_length += positions[i].distance_to(positions[i - 1]);
+        }
+    }
+    else if (curve_data.is_valid())
+    {
+        // The length comes from the chunk index, so no point data is read
+        // on the main thread.
+        lightmap_length = curve_data->get_range_length(curve_data_range.x,
+                                                       curve_data_range.y);
+        if (lightmap_length <= 0.0f)
+        {
+            return;
+        }
+    }
+    else
+    {
+        if (curve.is_null() || curve->get_point_count() <= 1)
+        {
+            return;
+        }
+        lightmap_length = curve->get_baked_length();
+        closed = curve->is_closed();
+    }
+
+    set_lightmap_size_hint(get_lightmap_size(lightmap_length, closed));
+}
+
+Vector2i CurveMesh::get_lightmap_size(float p_length, bool p_closed) const
+{
     Vector2i lightmap_size_hint;
     const float padding = get_uv2_padding();
-    float texel_size = _get_project_texel_size();
+    const float texel_size = _get_project_texel_size();
 
-    float lightmap_length = curve->get_baked_length();
-    if (extend_edges && !curve->is_closed())
+    if (extend_edges && !p_closed)
     {
         float extra_length = 1.0f;
         if (width_curve.is_valid())
@@ -76,10 +400,10 @@ void CurveMesh::_update_lightmap_size()
             extra_length += width_curve->sample(0.0f);
             extra_length += width_curve->sample(1.0f);
         }
-        lightmap_length += extra_length * width;
+        p_length += extra_length * width;
     }
     lightmap_size_hint.x = (int)Math::ceil(
-        Math::max(1.0f, lightmap_length / texel_size) + 2.0f * padding);
+        Math::max(1.0f, p_length / texel_size) + 2.0f * padding);
 
     float lightmap_width = width;
     if (width_curve.is_valid())
@@ -98,105 +422,715 @@ void CurveMesh::_update_lightmap_size()
         lightmap_width *= Math_PI;
         width_padding = 0.0f;
     }
+    else if (profile == PROFILE_CUSTOM)
+    {
+        lightmap_width *= profile_template.length;
+        width_padding = 0.0f;
+    }
 
     lightmap_size_hint.y = (int)Math::ceil(
         Math::max(1.0f, lightmap_width / texel_size) + width_padding * padding);
-    set_lightmap_size_hint(lightmap_size_hint);
+    return lightmap_size_hint;
+}
+
+float CurveMesh::get_lightmap_texel_size()
+{
+    return _get_project_texel_size();
 }
 
 Array CurveMesh::_create_mesh_array() const
 {
-    PackedVector3Array points;
-    PackedVector3Array normals;
-    PackedFloat32Array tangents;
-    PackedVector2Array uvs;
-    PackedVector2Array uv2s;
+    CURVE_MESH_PROFILE_ZONE("CurveMesh::_create_mesh_array");
+
+    if (finished_build_ready)
+    {
+        finished_build_ready = false;
+        Array arr = finished_build.arrays;
+        generated_aabb = finished_build.aabb;
+        generation_stats = finished_build.stats;
+        finished_build = BackgroundBuild();
+        const_cast<CurveMesh *>(this)->_update_lightmap_size();
+        return arr;
+    }
+
+    const bool preview = preview_requested;
+    preview_requested = false;
+    if (!preview)
+    {
+        // A full build supersedes any background build still in flight.
+        build_serial++;
+    }
+
+    const GenerationSettings settings = _get_generation_settings(preview);
+    CurveSnapshot snapshot;
+    _take_curve_snapshot(settings.tessellation_mode, snapshot);
+
+    GenerationStats stats;
+    AABB aabb;
+    bool triangle_strip = false;
+    const uint64_t begin_usec = Time::get_singleton()->get_ticks_usec();
+    Array arr = _generate_mesh_arrays(snapshot, settings, false,
+                                      triangle_strip, stats, aabb);
+    stats.preview = preview;
+
+    generated_aabb = aabb;
+    generation_stats = stats;
+    if (!preview)
+    {
+        last_build_usec = Time::get_singleton()->get_ticks_usec() - begin_usec;
+        // The lightmap size needs the baked length, which the preview skips.
+        const_cast<CurveMesh *>(this)->_update_lightmap_size();
+    }
+
+    return arr;
+}
+
+Ref<ArrayMesh> CurveMesh::create_triangle_strip_mesh() const
+{
+    GenerationSettings settings = _get_generation_settings(false);
+    CurveSnapshot snapshot;
+    _take_curve_snapshot(settings.tessellation_mode, snapshot);
+
+    GenerationStats stats;
+    AABB aabb;
+    bool triangle_strip = false;
+    Array arr = _generate_mesh_arrays(snapshot, settings, true, triangle_strip,
+                                      stats, aabb);
+
+    Ref<ArrayMesh> mesh;
+    mesh.instantiate();
+    mesh->add_surface_from_arrays(
+        triangle_strip ? Mesh::PRIMITIVE_TRIANGLE_STRIP
+                       : Mesh::PRIMITIVE_TRIANGLES,
+        arr);
+    if (get_material().is_valid())
+    {
+        mesh->surface_set_material(0, get_material());
+    }
+    return mesh;
+}
+
+CurveMesh::GenerationSettings
+CurveMesh::_get_generation_settings(bool p_preview) const
+{
+    GenerationSettings settings;
+    settings.width = width;
+    settings.width_curve = width_curve;
+    settings.extend_edges = extend_edges;
+    settings.tessellation_mode = tessellation_mode;
+    settings.tessellation_tolerance = tessellation_tolerance;
+    settings.decimation_tolerance = decimation_tolerance;
+    settings.up_vector = up_vector;
+    settings.follow_curve = follow_curve;
+    settings.corner_threshold = corner_threshold;
+    settings.smooth_shaded_corners = smooth_shaded_corners;
+    settings.profile = profile;
+    settings.segments = segments;
+    settings.profile_closed = profile_closed;
+    settings.profile_template = profile_template;
+    settings.profile_extent = get_profile_extent();
+    settings.interleave_vertices = interleave_vertices;
+    settings.filter_overlaps = filter_overlaps;
+    settings.filter_distant_overlaps =
+        filter_overlaps && filter_distant_overlaps;
+    settings.optimize_vertex_cache = optimize_vertex_cache;
+    settings.cull_degenerate_triangles = cull_degenerate_triangles;
+    settings.degenerate_area_threshold = degenerate_area_threshold;
+    settings.scale_uv_by_length = scale_uv_by_length;
+    settings.scale_uv_by_width = scale_uv_by_width;
+    settings.tile_segment_uv = tile_segment_uv;
+    settings.max_vertices = max_vertices;
+    settings.max_triangles = max_triangles;
+    settings.skin_bone_count = skin_bone_count;
+    settings.add_shader_channels = add_shader_channels;
+    settings.add_uv2 = get_add_uv2();
+    settings.uv2_padding = get_uv2_padding() * _get_project_texel_size();
+    if (use_direct_points)
+    {
+        settings.tessellation_mode = TESSELLATION_DISABLED;
+    }
+    else if (curve_data.is_valid())
+    {
+        // A file without handles holds center points, which are used as
+        // is. There is no Curve3D to bake, so baking tessellates instead.
+        if (!curve_data->has_handles())
+        {
+            settings.tessellation_mode = TESSELLATION_DISABLED;
+        }
+        else if (settings.tessellation_mode == TESSELLATION_BAKED)
+        {
+            settings.tessellation_mode = TESSELLATION_ADAPTIVE;
+        }
+    }
+
+    if (p_preview)
+    {
+        // Baked points would rebake the curve on every change, so the
+        // preview tessellates the control points instead.
+        if (settings.tessellation_mode == TESSELLATION_BAKED)
+        {
+            settings.tessellation_mode = TESSELLATION_ADAPTIVE;
+        }
+        settings.tessellation_tolerance = Math::max(
+            settings.tessellation_tolerance, preview_tessellation_tolerance);
+        const int minimum = (profile == PROFILE_TUBE) ? 3 : 2;
+        settings.segments =
+            Math::min(segments, Math::max(preview_segments, minimum));
+        settings.filter_overlaps = false;
+        settings.filter_distant_overlaps = false;
+        settings.optimize_vertex_cache = false;
+    }
+
+    return settings;
+}
+
+int CurveMesh::_get_radial_segments(const GenerationSettings &settings) const
+{
+    if (settings.profile == PROFILE_FLAT)
+    {
+        return 1;
+    }
+    if (settings.profile == PROFILE_CUSTOM)
+    {
+        return settings.profile_template.positions.size();
+    }
+    return settings.segments;
+}
+
+Vector2i
+CurveMesh::_estimate_counts(const LocalVector<CenterPoint> &center_points,
+                            bool closed, int radial_segments,
+                            const GenerationSettings &settings) const
+{
+    // Mirrors the ring layout of _generate_edge_vertices(): one ring per
+    // center point, plus a second ring at each corner when corners are not
+    // smooth shaded. Those duplicate rings are not joined to their
+    // originals. Interleaving, filtering and culling only ever remove
+    // geometry, so the result is an upper bound.
+    const int point_count = center_points.size();
+    if (point_count < 2 || radial_segments < 1)
+    {
+        return Vector2i();
+    }
+
+    int duplicate_rings = 0;
+    if (!settings.smooth_shaded_corners)
+    {
+        const float corner_scalar_threshold =
+            Math::cos(settings.corner_threshold);
+        for (const CenterPoint &point : center_points)
+        {
+            if (point.corner_point ||
+                point.tangent_prev.dot(point.tangent_next) <
+                    corner_scalar_threshold)
+            {
+                duplicate_rings++;
+            }
+        }
+    }
+
+    const int ring_count = point_count + duplicate_rings;
+    const int linked_rings =
+        (closed ? ring_count : ring_count - 1) - duplicate_rings;
+
+    int faces_per_link = radial_segments;
+    if (settings.profile == PROFILE_CUSTOM)
+    {
+        faces_per_link = 0;
+        for (uint8_t connected : settings.profile_template.connect_next)
+        {
+            faces_per_link += connected;
+        }
+    }
+
+    return Vector2i(ring_count * _get_edge_count(settings.profile) *
+                        radial_segments,
+                    Math::max(linked_rings, 0) * faces_per_link * 2);
+}
+
+bool CurveMesh::_fit_to_budget(const CurveSnapshot &snapshot,
+                               GenerationSettings &settings,
+                               LocalVector<CenterPoint> &center_points,
+                               real_t &total_length) const
+{
+    const int minimum_segments = (settings.profile == PROFILE_TUBE) ? 3 : 2;
+    const bool has_segments =
+        settings.profile == PROFILE_CROSS || settings.profile == PROFILE_TUBE;
+    bool along_exhausted = false;
+
+    _generate_curve_points(snapshot, settings, center_points, total_length);
+    for (int attempt = 0; attempt < 32; attempt++)
+    {
+        const Vector2i counts =
+            _estimate_counts(center_points, snapshot.closed,
+                             _get_radial_segments(settings), settings);
+        if ((settings.max_vertices <= 0 || counts.x <= settings.max_vertices) &&
+            (settings.max_triangles <= 0 || counts.y <= settings.max_triangles))
+        {
+            return true;
+        }
+
+        // Alternate between fewer rings along the curve and fewer segments
+        // around it, so neither gets all of the loss.
+        const bool can_lower_segments =
+            has_segments && settings.segments > minimum_segments;
+        if (can_lower_segments && (along_exhausted || attempt % 2 == 1))
+        {
+            settings.segments =
+                Math::max(minimum_segments,
+                          settings.segments - Math::max(settings.segments / 4,
+                                                        1));
+            continue;
+        }
+        if (along_exhausted)
+        {
+            return false;
+        }
+
+        if (settings.tessellation_mode == TESSELLATION_ADAPTIVE)
+        {
+            along_exhausted = settings.tessellation_tolerance >= 90.0f;
+            settings.tessellation_tolerance =
+                Math::min(settings.tessellation_tolerance * 2.0f, 90.0f);
+        }
+        else
+        {
+            // Past the curve length only corners and ends survive.
+            along_exhausted = settings.decimation_tolerance > total_length;
+            settings.decimation_tolerance =
+                Math::max(settings.decimation_tolerance * 4.0f, 0.001f);
+        }
+        if (!along_exhausted)
+        {
+            _generate_curve_points(snapshot, settings, center_points,
+                                   total_length);
+        }
+    }
+    return false;
+}
+
+Array CurveMesh::_generate_mesh_arrays(const CurveSnapshot &snapshot,
+                                       const GenerationSettings &p_settings,
+                                       bool p_triangle_strip,
+                                       bool &r_triangle_strip,
+                                       GenerationStats &r_stats,
+                                       AABB &r_aabb,
+                                       PackedInt32Array *r_end_rings) const
+{
+    VertexArrays arrays;
     PackedInt32Array indices;
 
-    const bool add_uv2 = get_add_uv2();
-    const float uv2_padding = get_uv2_padding() * _get_project_texel_size();
+    const bool add_uv2 = p_settings.add_uv2;
+    r_triangle_strip = false;
 
-    if (curve.is_valid() && curve->get_point_count() > 1)
+    if (snapshot.point_count > 1)
     {
         LocalVector<CenterPoint> center_points;
         real_t total_length = 0.0;
-        _generate_curve_points(center_points, total_length);
+        GenerationSettings settings = p_settings;
+        if (settings.max_vertices > 0 || settings.max_triangles > 0)
+        {
+            CURVE_MESH_PROFILE_ZONE("CurveMesh fit to budget");
+            r_stats.budget_exceeded = !_fit_to_budget(
+                snapshot, settings, center_points, total_length);
+        }
+        else
+        {
+            CURVE_MESH_PROFILE_ZONE("CurveMesh curve points");
+            _generate_curve_points(snapshot, settings, center_points,
+                                   total_length);
+        }
+
+        if (settings.decimation_tolerance > 0.0f &&
+            settings.tessellation_mode != TESSELLATION_ADAPTIVE)
+        {
+            int source_count = snapshot.point_count;
+            if (settings.tessellation_mode == TESSELLATION_BAKED)
+            {
+                source_count = snapshot.baked_points.size();
+                if (snapshot.closed)
+                {
+                    source_count--;
+                }
+            }
+            if (source_count > 0)
+            {
+                r_stats.decimation_ratio =
+                    1.0f - (float)center_points.size() / source_count;
+            }
+        }
+
+        const int radial_segments = _get_radial_segments(settings);
+        const int edge_count = _get_edge_count(settings.profile);
 
-        if (center_points.size() >= 2)
+        if (center_points.size() >= 2 && radial_segments >= 1)
         {
+            CURVE_MESH_PROFILE_ALLOC(center_points.ptr(),
+                                     center_points.size() *
+                                         sizeof(CenterPoint));
+
             LocalVector<EdgePoint> edge_points;
-            const int radial_segments =
-                (profile == PROFILE_FLAT) ? 1 : segments;
-            _generate_edge_vertices(center_points, total_length,
-                                    radial_segments, uv2_padding, edge_points);
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh edge vertices");
+                _generate_edge_vertices(center_points, total_length,
+                                        radial_segments, settings,
+                                        snapshot.closed, edge_points);
+            }
+            CURVE_MESH_PROFILE_ALLOC(edge_points.ptr(),
+                                     edge_points.size() * sizeof(EdgePoint));
 
-            if (interleave_vertices && profile != PROFILE_TUBE)
+            if (settings.interleave_vertices && edge_count == 2)
             {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh interleave");
                 _interleave_edge_vertices(edge_points, center_points,
                                           radial_segments);
             }
 
-            if (filter_overlaps)
+            if (settings.filter_distant_overlaps)
             {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh distant overlaps");
+                _mark_distant_overlaps(edge_points, center_points,
+                                       total_length, radial_segments, settings,
+                                       snapshot.closed);
+            }
+
+            if (settings.filter_overlaps)
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh filter overlaps");
                 _filter_overlapping_vertices(edge_points, center_points,
-                                             radial_segments);
+                                             radial_segments, settings,
+                                             snapshot.closed);
             }
 
-            _generate_triangles(edge_points, radial_segments, points, normals,
-                                tangents, uvs, uv2s, indices);
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh vertices");
+                _generate_vertices(edge_points, settings, snapshot.closed,
+                                   arrays, r_aabb);
+            }
+
+            if (r_end_rings != nullptr)
+            {
+                // Edge points are laid out ring by ring, so the first and
+                // last block hold the end rings; removed points are skipped.
+                const int block = edge_count * radial_segments;
+                const int last_block = (int)edge_points.size() - block;
+                for (int k = 0; k < block; k++)
+                {
+                    const EdgePoint &first = edge_points[k];
+                    const EdgePoint &last = edge_points[last_block + k];
+                    if (!first.removed)
+                    {
+                        r_end_rings[0].push_back(first.source_index);
+                    }
+                    if (!last.removed)
+                    {
+                        r_end_rings[1].push_back(last.source_index);
+                    }
+                }
+            }
+
+            if (p_triangle_strip)
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh triangle strip");
+                r_triangle_strip = _generate_triangle_strip(
+                    edge_points, radial_segments, edge_count, indices);
+            }
+
+            if (!r_triangle_strip)
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh triangles");
+                CompactColumns columns;
+                _compact_edge_points(edge_points, radial_segments, edge_count,
+                                     columns);
+                if (settings.profile == PROFILE_CUSTOM)
+                {
+                    columns.connected = settings.profile_template.connect_next;
+                }
+                _generate_triangles(columns, radial_segments, edge_count,
+                                    indices);
+            }
+
+            if (settings.cull_degenerate_triangles && !r_triangle_strip)
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh cull degenerate");
+                r_stats.culled_triangle_count = _cull_degenerate_triangles(
+                    indices, settings.degenerate_area_threshold, arrays,
+                    r_aabb);
+            }
+
+            if (settings.optimize_vertex_cache && !r_triangle_strip &&
+                !indices.is_empty())
+            {
+                CURVE_MESH_PROFILE_ZONE("CurveMesh vertex cache");
+                const int vertex_count = arrays.points.size();
+                r_stats.acmr_before =
+                    VertexCacheOptimizer::compute_acmr(indices, vertex_count);
+                VertexCacheOptimizer::optimize(indices, vertex_count);
+                r_stats.acmr_after =
+                    VertexCacheOptimizer::compute_acmr(indices, vertex_count);
+            }
+
+            CURVE_MESH_PROFILE_FREE(edge_points.ptr());
+            CURVE_MESH_PROFILE_FREE(center_points.ptr());
         }
     }
 
+    r_stats.vertex_count = arrays.points.size();
+    r_stats.triangle_count =
+        r_triangle_strip ? Math::max((int)indices.size() - 2, 0)
+                         : (int)indices.size() / 3;
+    CURVE_MESH_PROFILE_PLOT("CurveMesh vertices", r_stats.vertex_count);
+    CURVE_MESH_PROFILE_PLOT("CurveMesh triangles", r_stats.triangle_count);
+
     if (indices.is_empty())
     {
-        points.push_back(Vector3());
-        normals.push_back(Vector3(0.0, 1.0, 0.0));
-        uvs.push_back(Vector2());
+        arrays = VertexArrays();
+        arrays.points.push_back(Vector3());
+        arrays.normals.push_back(Vector3(0.0, 1.0, 0.0));
+        arrays.uvs.push_back(Vector2());
         if (add_uv2)
         {
-            uv2s.push_back(Vector2());
+            arrays.uv2s.push_back(Vector2());
+        }
+        arrays.tangents.push_back(1.0f);
+        arrays.tangents.push_back(0.0f);
+        arrays.tangents.push_back(0.0f);
+        arrays.tangents.push_back(1.0f);
+        if (p_settings.skin_bone_count > 0)
+        {
+            _add_skin_weights(0.0f, 1, false, arrays.bones, arrays.weights);
+        }
+        if (p_settings.add_shader_channels)
+        {
+            _add_shader_channels(0.0f, Vector3(), Vector3(0.0f, 1.0f, 0.0f),
+                                 arrays.custom0, arrays.custom1);
         }
-        tangents.push_back(1.0f);
-        tangents.push_back(0.0f);
-        tangents.push_back(0.0f);
-        tangents.push_back(1.0f);
         indices.push_back(0);
         indices.push_back(0);
         indices.push_back(0);
+        r_aabb = AABB();
+        r_triangle_strip = false;
+        if (r_end_rings != nullptr)
+        {
+            r_end_rings[0].clear();
+            r_end_rings[1].clear();
+        }
     }
 
     Array arr;
     arr.resize(Mesh::ARRAY_MAX);
-    arr[Mesh::ARRAY_VERTEX] = points;
-    arr[Mesh::ARRAY_NORMAL] = normals;
-    arr[Mesh::ARRAY_TANGENT] = tangents;
-    arr[Mesh::ARRAY_TEX_UV] = uvs;
+    arr[Mesh::ARRAY_VERTEX] = arrays.points;
+    arr[Mesh::ARRAY_NORMAL] = arrays.normals;
+    arr[Mesh::ARRAY_TANGENT] = arrays.tangents;
+    arr[Mesh::ARRAY_TEX_UV] = arrays.uvs;
     if (add_uv2)
     {
-        arr[Mesh::ARRAY_TEX_UV2] = uv2s;
+        arr[Mesh::ARRAY_TEX_UV2] = arrays.uv2s;
+    }
+    if (p_settings.skin_bone_count > 0)
+    {
+        arr[Mesh::ARRAY_BONES] = arrays.bones;
+        arr[Mesh::ARRAY_WEIGHTS] = arrays.weights;
+    }
+    if (p_settings.add_shader_channels)
+    {
+        arr[Mesh::ARRAY_CUSTOM0] = arrays.custom0;
+        arr[Mesh::ARRAY_CUSTOM1] = arrays.custom1;
     }
     arr[Mesh::ARRAY_INDEX] = indices;
 
-    const_cast<CurveMesh *>(this)->_update_lightmap_size();
-
     return arr;
 }
 
-void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
+void CurveMesh::_take_curve_snapshot(TessellationMode p_mode,
+                                     CurveSnapshot &r_snapshot) const
+{
+    if (use_direct_points)
+    {
+        // Packed arrays are copy-on-write, so the snapshot only takes a
+        // reference and a later set_points() call never races the worker.
+        r_snapshot.point_count = point_positions.size();
+        r_snapshot.point_positions = point_positions;
+        r_snapshot.point_tilts = point_tilts;
+        r_snapshot.point_widths = point_widths;
+        return;
+    }
+
+    if (curve_data.is_valid())
+    {
+        // Only the chunks covering curve_data_range are read from the file.
+        CurveDataFile::Points points;
+        if (!curve_data->read_range(curve_data_range.x, curve_data_range.y,
+                                    points))
+        {
+            return;
+        }
+
+        const int point_count = points.positions.size();
+        r_snapshot.point_count = point_count;
+        r_snapshot.closed = curve_data->is_closed() &&
+                            point_count == curve_data->get_point_count();
+        if (p_mode == TESSELLATION_DISABLED)
+        {
+            r_snapshot.point_positions = points.positions;
+            r_snapshot.point_tilts = points.tilts;
+            r_snapshot.point_widths = points.widths;
+            return;
+        }
+
+        // Tessellated control points carry no width, like a Curve3D.
+        const bool has_tilts = points.tilts.size() == point_count;
+        r_snapshot.positions.resize(point_count);
+        r_snapshot.in_handles.resize(point_count);
+        r_snapshot.out_handles.resize(point_count);
+        r_snapshot.tilts.resize(point_count);
+        for (int i = 0; i < point_count; i++)
+        {
+            r_snapshot.positions[i] = points.positions[i];
+            r_snapshot.in_handles[i] = points.in_handles[i];
+            r_snapshot.out_handles[i] = points.out_handles[i];
+            r_snapshot.tilts[i] = has_tilts ? points.tilts[i] : 0.0f;
+        }
+        return;
+    }
+
+    _take_curve3d_snapshot(curve, p_mode, r_snapshot);
+}
+
+void CurveMesh::_take_curve3d_snapshot(const Ref<Curve3D> &curve,
+                                       TessellationMode p_mode,
+                                       CurveSnapshot &r_snapshot)
+{
+    if (curve.is_null())
+    {
+        return;
+    }
+
+    r_snapshot.point_count = curve->get_point_count();
+    r_snapshot.closed = curve->is_closed();
+
+    if (p_mode == TESSELLATION_BAKED)
+    {
+        r_snapshot.baked_points = curve->get_baked_points();
+        r_snapshot.baked_tilts = curve->get_baked_tilts();
+        return;
+    }
+
+    // The "_data" property packs in/out/position triplets and tilts of all
+    // control points, so a single call replaces three per point.
+    const Dictionary data = curve->get("_data");
+    const PackedVector3Array packed_points =
+        data.get("points", PackedVector3Array());
+    const PackedFloat32Array packed_tilts =
+        data.get("tilts", PackedFloat32Array());
+    int point_count = packed_tilts.size();
+    if (packed_points.size() != point_count * 3)
+    {
+        point_count = 0;
+    }
+
+    if (point_count == 0)
+    {
+        point_count = r_snapshot.point_count;
+        r_snapshot.positions.resize(point_count);
+        r_snapshot.in_handles.resize(point_count);
+        r_snapshot.out_handles.resize(point_count);
+        r_snapshot.tilts.resize(point_count);
+        for (int i = 0; i < point_count; i++)
+        {
+            r_snapshot.positions[i] = curve->get_point_position(i);
+            r_snapshot.in_handles[i] = curve->get_point_in(i);
+            r_snapshot.out_handles[i] = curve->get_point_out(i);
+            r_snapshot.tilts[i] = curve->get_point_tilt(i);
+        }
+        return;
+    }
+
+    const Vector3 *packed = packed_points.ptr();
+    r_snapshot.positions.resize(point_count);
+    r_snapshot.in_handles.resize(point_count);
+    r_snapshot.out_handles.resize(point_count);
+    r_snapshot.tilts.resize(point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+        r_snapshot.in_handles[i] = packed[i * 3 + 0];
+        r_snapshot.out_handles[i] = packed[i * 3 + 1];
+        r_snapshot.positions[i] = packed[i * 3 + 2];
+        r_snapshot.tilts[i] = packed_tilts[i];
+    }
+}
+
+void CurveMesh::_tessellate_snapshot(const CurveSnapshot &snapshot,
+                                     LocalVector<CenterPoint> &center_points,
+                                     int max_stages, float tolerance) const
+{
+    // Same subdivision as Curve3D::tessellate(), run on the snapshot so it
+    // does not touch the resource.
+    const int control_count = snapshot.positions.size();
+    const int segment_count =
+        snapshot.closed ? control_count : control_count - 1;
+    const float tolerance_cos = Math::cos(Math::deg_to_rad(tolerance));
+
+    LocalVector<Vector3> positions;
+    positions.reserve(control_count * 2);
+    positions.push_back(snapshot.positions[0]);
+    for (int i = 0; i < segment_count; i++)
+    {
+        const int next = (i + 1) % control_count;
+        const Vector3 &a = snapshot.positions[i];
+        const Vector3 &b = snapshot.positions[next];
+        _tessellate_segment(positions, a, a + snapshot.out_handles[i],
+                            b + snapshot.in_handles[next], b, 0.0f, 1.0f, 0,
+                            max_stages, tolerance_cos);
+        if (next != 0)
+        {
+            positions.push_back(b);
+        }
+    }
+
+    center_points.resize(positions.size());
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        center_points[i].position = positions[i];
+        center_points[i].tilt = 0.0f;
+    }
+}
+
+PackedVector3Array CurveMesh::tessellate_snapshot(const CurveSnapshot &snapshot,
+                                                  float p_tolerance) const
+{
+    LocalVector<CenterPoint> center_points;
+    _tessellate_snapshot(snapshot, center_points, 5, p_tolerance);
+
+    PackedVector3Array positions;
+    positions.resize(center_points.size());
+    Vector3 *positions_data = positions.ptrw();
+    for (uint32_t i = 0; i < center_points.size(); i++)
+    {
+        positions_data[i] = center_points[i].position;
+    }
+    return positions;
+}
+
+void CurveMesh::_generate_curve_points(const CurveSnapshot &snapshot,
+                                       const GenerationSettings &settings,
+                                       LocalVector<CenterPoint> &center_points,
                                        real_t &total_length) const
 {
     int point_count = 0;
-    switch (tessellation_mode)
+    const bool closed = snapshot.closed;
+    switch (settings.tessellation_mode)
     {
     case TESSELLATION_BAKED:
     {
-        PackedVector3Array pts = curve->get_baked_points();
-        PackedFloat32Array tilts = curve->get_baked_tilts();
+        const PackedVector3Array &pts = snapshot.baked_points;
+        const PackedFloat32Array &tilts = snapshot.baked_tilts;
         point_count = pts.size();
-        if (curve->is_closed())
+        if (closed)
         {
             point_count--;
         }
+        point_count = Math::max(point_count, 0);
         center_points.resize(point_count);
         for (int i = 0; i < point_count; i++)
         {
@@ -207,33 +1141,61 @@ void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
     break;
     case TESSELLATION_ADAPTIVE:
     {
-        PackedVector3Array pts = curve->tessellate(5, tessellation_tolerance);
-        point_count = pts.size();
-        if (curve->is_closed())
-        {
-            point_count--;
-        }
-        center_points.resize(point_count);
-        for (int i = 0; i < point_count; i++)
-        {
-            center_points[i].position = pts[i];
-            center_points[i].tilt = 0.0f;
-        }
+        _tessellate_snapshot(snapshot, center_points, 5,
+                             settings.tessellation_tolerance);
+        point_count = center_points.size();
     }
     break;
     case TESSELLATION_DISABLED:
     {
-        point_count = curve->get_point_count();
+        if (!snapshot.point_positions.is_empty())
+        {
+            _read_direct_points(snapshot, center_points);
+            point_count = center_points.size();
+            break;
+        }
+
+        point_count = snapshot.positions.size();
         center_points.resize(point_count);
         for (int i = 0; i < point_count; i++)
         {
-            center_points[i].position = curve->get_point_position(i);
-            center_points[i].tilt = curve->get_point_tilt(i);
+            center_points[i].position = snapshot.positions[i];
+            center_points[i].tilt = snapshot.tilts[i];
         }
     }
     break;
     }
 
+    // Context points only lend their direction to the end tangents. They
+    // go before decimation, which keeps the end points they orient.
+    bool lead_context = snapshot.lead_context && !closed;
+    bool trail_context = snapshot.trail_context && !closed;
+    if (point_count < 2 + (int)lead_context + (int)trail_context)
+    {
+        lead_context = false;
+        trail_context = false;
+    }
+    Vector3 lead_position;
+    Vector3 trail_position;
+    if (trail_context)
+    {
+        trail_position = center_points[point_count - 1].position;
+        center_points.resize(point_count - 1);
+    }
+    if (lead_context)
+    {
+        lead_position = center_points[0].position;
+        center_points.remove_at(0);
+    }
+    point_count = center_points.size();
+
+    if (settings.decimation_tolerance > 0.0f &&
+        settings.tessellation_mode != TESSELLATION_ADAPTIVE)
+    {
+        _decimate_curve_points(center_points, settings, closed);
+        point_count = center_points.size();
+    }
+
     if (point_count < 2)
     {
         total_length = 0;
@@ -243,12 +1205,16 @@ void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
     Vector3 next = center_points[1].position;
     Vector3 next_dir = (next - center_points[0].position).normalized();
     Vector3 prev_dir = next_dir;
-    if (curve->is_closed())
+    if (closed)
     {
         prev_dir = (center_points[0].position -
                     center_points[point_count - 1].position)
                        .normalized();
     }
+    else if (lead_context)
+    {
+        prev_dir = (center_points[0].position - lead_position).normalized();
+    }
 
     center_points[0].tangent_prev = prev_dir;
     center_points[0].tangent_next = next_dir;
@@ -256,13 +1222,14 @@ void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
     total_length = 0.0;
     center_points[0].partial_length = total_length;
 
-    if (extend_edges && !curve->is_closed())
+    if (settings.extend_edges && !closed && !lead_context)
     {
-        float extra_width = width * 0.5f;
-        if (width_curve.is_valid())
+        float extra_width = settings.width * 0.5f;
+        if (settings.width_curve.is_valid())
         {
-            extra_width *= width_curve->sample(0.0f);
+            extra_width *= settings.width_curve->sample(0.0f);
         }
+        extra_width *= center_points[0].width;
         center_points[0].position -= next_dir * extra_width;
         total_length += extra_width;
     }
@@ -288,7 +1255,7 @@ void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
     next_dir = prev_dir;
     total_length += prev_length;
     center_points[point_count - 1].partial_length = total_length;
-    if (curve->is_closed())
+    if (closed)
     {
         next_dir = (center_points[0].position -
                     center_points[point_count - 1].position);
@@ -299,44 +1266,287 @@ void CurveMesh::_generate_curve_points(LocalVector<CenterPoint> &center_points,
         }
         total_length += extra_length;
     }
+    else if (trail_context)
+    {
+        next_dir = (trail_position - center_points[point_count - 1].position)
+                       .normalized();
+    }
     center_points[point_count - 1].tangent_prev = prev_dir;
     center_points[point_count - 1].tangent_next = next_dir;
 
-    if (extend_edges && !curve->is_closed())
+    if (settings.extend_edges && !closed && !trail_context)
     {
-        float extra_width = width * 0.5f;
-        if (width_curve.is_valid())
+        float extra_width = settings.width * 0.5f;
+        if (settings.width_curve.is_valid())
         {
-            extra_width *= width_curve->sample(1.0f);
+            extra_width *= settings.width_curve->sample(1.0f);
         }
+        extra_width *= center_points[point_count - 1].width;
         center_points[point_count - 1].position += next_dir * extra_width;
         total_length += extra_width;
         center_points[point_count - 1].partial_length += extra_width;
     }
 
-    if (!curve->is_closed())
+    if (!closed && !trail_context)
     {
         center_points[point_count - 1].corner_point = true;
+    }
+    if (!closed && !lead_context)
+    {
         center_points[0].corner_point = true;
     }
 }
 
-void CurveMesh::_generate_edge_vertices(
+void CurveMesh::_read_direct_points(
+    const CurveSnapshot &snapshot,
+    LocalVector<CenterPoint> &center_points) const
+{
+    const int point_count = snapshot.point_positions.size();
+    const bool has_tilts = snapshot.point_tilts.size() == point_count;
+    const bool has_widths = snapshot.point_widths.size() == point_count;
+    const Vector3 *positions = snapshot.point_positions.ptr();
+    const float *tilts = has_tilts ? snapshot.point_tilts.ptr() : nullptr;
+    const float *widths = has_widths ? snapshot.point_widths.ptr() : nullptr;
+
+    center_points.resize(point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+        CenterPoint &center_point = center_points[i];
+        center_point = CenterPoint();
+        center_point.position = positions[i];
+        if (tilts)
+        {
+            center_point.tilt = tilts[i];
+        }
+        if (widths)
+        {
+            center_point.width = widths[i];
+        }
+    }
+}
+
+float CurveMesh::get_profile_extent() const
+{
+    // Distance of the farthest profile vertex from the centerline, per unit
+    // of width * width_curve.
+    if (profile != PROFILE_CUSTOM)
+    {
+        return 0.5f;
+    }
+
+    float profile_extent = 0.0f;
+    for (const Vector2 &position : profile_template.positions)
+    {
+        profile_extent = Math::max(profile_extent, position.length());
+    }
+    return profile_extent;
+}
+
+void CurveMesh::_decimate_curve_points(
+    LocalVector<CenterPoint> &center_points,
+    const GenerationSettings &settings, bool closed) const
+{
+    const int point_count = center_points.size();
+    if (point_count < 3)
+    {
+        return;
+    }
+
+    const float profile_extent = settings.profile_extent;
+
+    LocalVector<float> distances;
+    distances.resize(point_count);
+    distances[0] = 0.0f;
+    for (int i = 1; i < point_count; i++)
+    {
+        distances[i] =
+            distances[i - 1] + center_points[i].position.distance_to(
+                                   center_points[i - 1].position);
+    }
+    float total_distance = distances[point_count - 1];
+    if (closed)
+    {
+        total_distance += center_points[0].position.distance_to(
+            center_points[point_count - 1].position);
+    }
+    if (total_distance <= 0.0f)
+    {
+        return;
+    }
+
+    LocalVector<float> radii;
+    radii.resize(point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+        float local_width = 1.0f;
+        if (settings.width_curve.is_valid())
+        {
+            local_width =
+                settings.width_curve->sample(distances[i] / total_distance);
+        }
+        local_width *= center_points[i].width;
+        radii[i] = Math::abs(settings.width * local_width) * profile_extent;
+    }
+
+    // Corners are split points of the simplification, so their sharp
+    // shading and width correction survive no matter how small the kink.
+    const float corner_scalar_threshold = Math::cos(settings.corner_threshold);
+    LocalVector<int> anchors;
+    anchors.push_back(0);
+    for (int i = 1; i < point_count - 1; i++)
+    {
+        const Vector3 prev_dir =
+            (center_points[i].position - center_points[i - 1].position)
+                .normalized();
+        const Vector3 next_dir =
+            (center_points[i + 1].position - center_points[i].position)
+                .normalized();
+        if (prev_dir.dot(next_dir) < corner_scalar_threshold)
+        {
+            anchors.push_back(i);
+        }
+    }
+    anchors.push_back(point_count - 1);
+
+    LocalVector<uint8_t> keep;
+    keep.resize(point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+        keep[i] = 0;
+    }
+    for (int anchor : anchors)
+    {
+        keep[anchor] = 1;
+    }
+
+    // Douglas-Peucker on the swept surface: a point may go when the rings
+    // interpolated between the kept neighbours stay within the tolerance of
+    // its own ring. The error adds the centerline distance, the change in
+    // radius, and the arc the ring edge moves by when its tilt or tangent
+    // is replaced by the interpolated one.
+    LocalVector<Vector2i> stack;
+    for (uint32_t k = 0; k + 1 < anchors.size(); k++)
+    {
+        stack.push_back(Vector2i(anchors[k], anchors[k + 1]));
+    }
+
+    const float tolerance = settings.decimation_tolerance;
+    while (!stack.is_empty())
+    {
+        const Vector2i range = stack[stack.size() - 1];
+        stack.resize(stack.size() - 1);
+        const int begin = range.x;
+        const int end = range.y;
+        if (end - begin < 2)
+        {
+            continue;
+        }
+
+        const CenterPoint &a = center_points[begin];
+        const CenterPoint &b = center_points[end];
+        const Vector3 chord = b.position - a.position;
+        const float chord_length_sq = chord.length_squared();
+        const Vector3 chord_dir =
+            chord_length_sq > 0.0f ? chord / Math::sqrt(chord_length_sq)
+                                   : Vector3();
+        const float span = distances[end] - distances[begin];
+
+        float max_error = -1.0f;
+        int max_index = -1;
+        for (int i = begin + 1; i < end; i++)
+        {
+            const CenterPoint &point = center_points[i];
+            const float t =
+                span > 0.0f ? (distances[i] - distances[begin]) / span : 0.5f;
+
+            float along = 0.0f;
+            if (chord_length_sq > 0.0f)
+            {
+                along = Math::clamp(
+                    (point.position - a.position).dot(chord) / chord_length_sq,
+                    0.0f, 1.0f);
+            }
+            float error =
+                point.position.distance_to(a.position + chord * along);
+
+            error += Math::abs(radii[i] - Math::lerp(radii[begin],
+                                                     radii[end], t));
+
+            const Vector3 tangent =
+                (center_points[i + 1].position -
+                 center_points[i - 1].position)
+                    .normalized();
+            const float bend = Math::acos(
+                Math::clamp(tangent.dot(chord_dir), -1.0f, 1.0f));
+            const float twist = Math::abs(point.tilt - Math::lerp(a.tilt,
+                                                                  b.tilt, t));
+            error += radii[i] * (bend + twist);
+
+            if (error > max_error)
+            {
+                max_error = error;
+                max_index = i;
+            }
+        }
+
+        if (max_error > tolerance)
+        {
+            keep[max_index] = 1;
+            stack.push_back(Vector2i(begin, max_index));
+            stack.push_back(Vector2i(max_index, end));
+        }
+    }
+
+    int write = 0;
+    for (int i = 0; i < point_count; i++)
+    {
+        if (keep[i])
+        {
+            center_points[write++] = center_points[i];
+        }
+    }
+    center_points.resize(write);
+}
+
+template <CurveMesh::Profile PROFILE, int RING_SIZE, bool ZERO_WIDTH,
+          bool ADD_UV2>
+void CurveMesh::_generate_edge_vertices_kernel(
     LocalVector<CenterPoint> &center_points, real_t total_length,
-    int radial_segments, float uv2_padding,
+    int radial_segments, const GenerationSettings &settings, bool closed,
     LocalVector<EdgePoint> &edge_points) const
 {
-    const Vector3 up_vector_normalized = up_vector.normalized();
+    const int ring_size = (RING_SIZE > 0) ? RING_SIZE : radial_segments;
+
+    const Vector3 up_vector_normalized = settings.up_vector.normalized();
     float segment_angle = Math_PI;
-    if (profile == PROFILE_CROSS)
+    if (PROFILE == PROFILE_CROSS)
     {
-        segment_angle = Math_PI / radial_segments;
+        segment_angle = Math_PI / ring_size;
     }
-    else if (profile == PROFILE_TUBE)
+    else if (PROFILE == PROFILE_TUBE)
+    {
+        segment_angle = Math_PI * 2.0f / ring_size;
+    }
+
+    // Spokes and normals are rotated about the tangent by the same angles on
+    // every ring. Fixed ring sizes keep the table on the stack, so the ring
+    // loops below run a compile-time count the compiler can unroll.
+    std::array<Vector2, (RING_SIZE > 0) ? RING_SIZE : 1> fixed_rotations;
+    LocalVector<Vector2> dynamic_rotations;
+    Vector2 *rotations = fixed_rotations.data();
+    if (RING_SIZE == 0)
+    {
+        dynamic_rotations.resize(ring_size);
+        rotations = dynamic_rotations.ptr();
+    }
+    for (int j = 0; j < ring_size; j++)
     {
-        segment_angle = Math_PI * 2.0f / radial_segments;
+        rotations[j] = Vector2(Math::cos(j * segment_angle),
+                               Math::sin(j * segment_angle));
     }
 
+    const float uv2_padding = settings.uv2_padding;
+    const Ref<Curve> &width_curve = settings.width_curve;
     const float horizontal_total = total_length + 2.0f * uv2_padding;
     const float length_h = (horizontal_total <= 0.0f || total_length <= 0.0f)
                                ? 0.0f
@@ -348,26 +1558,39 @@ void CurveMesh::_generate_edge_vertices(
         width_curve.is_valid() ? Math::max(width_curve->get_max_value(),
                                            -width_curve->get_min_value())
                                : 1.0f;
-    const float max_width = width * max_width_sample;
-    const float length_v = 1.0f / radial_segments;
+    float max_point_width = 0.0f;
+    for (const CenterPoint &center_point : center_points)
+    {
+        max_point_width =
+            Math::max(max_point_width, Math::abs(center_point.width));
+    }
+    const float max_width = settings.width * max_width_sample * max_point_width;
+    const float length_v = 1.0f / ring_size;
     const float edge_padding =
         length_v *
-        ((profile == PROFILE_TUBE)
+        ((PROFILE == PROFILE_TUBE)
              ? 1.0f
              : (max_width <= 0.0f ? 1.0f
                                   : max_width / (max_width + uv2_padding)));
+    const bool tile_cross_uv =
+        (PROFILE == PROFILE_CROSS) && settings.tile_segment_uv;
+
+    // A span maps its own length onto its share of the whole curve. UV2
+    // stays per span, since every span gets its own lightmap.
+    const float span_begin = settings.span_begin;
+    const float span_scale = settings.span_end - settings.span_begin;
+    const float uv_length =
+        (settings.span_length > 0.0f) ? settings.span_length : total_length;
 
     Vector3 current_up = up_vector_normalized;
 
     const int point_count = center_points.size();
-    const int edge_count = (profile == PROFILE_TUBE) ? 1 : 2;
+    const int edge_count = _get_edge_count(settings.profile);
 
-    const float corner_scalar_threshold = Math::cos(corner_threshold);
-    const bool zero_width = Math::is_zero_approx(width);
-    const bool add_uv2 = get_add_uv2();
+    const float corner_scalar_threshold = Math::cos(settings.corner_threshold);
 
     edge_points.clear();
-    edge_points.reserve(point_count * edge_count * radial_segments);
+    edge_points.reserve(point_count * edge_count * ring_size);
 
     for (int i = 0; i < point_count; i++)
     {
@@ -378,14 +1601,17 @@ void CurveMesh::_generate_edge_vertices(
             (corner_cosine < corner_scalar_threshold);
 
         float local_width = 1.0f;
-        float u = (total_length > 0.0f)
-                      ? center_points[i].partial_length / total_length
-                      : 0.0f;
+        const float span_u =
+            (total_length > 0.0f)
+                ? center_points[i].partial_length / total_length
+                : 0.0f;
+        float u = span_begin + span_u * span_scale;
 
         if (width_curve.is_valid())
         {
             local_width = width_curve->sample(u);
         }
+        local_width *= center_points[i].width;
 
         Vector3 binormal;
         Vector3 spoke;
@@ -396,12 +1622,13 @@ void CurveMesh::_generate_edge_vertices(
         real_t width_correction = 1.0f;
         Vector3 width_correction_dir;
 
-        if (!zero_width)
+        if (!ZERO_WIDTH)
         {
-            if (!follow_curve)
+            if (!settings.follow_curve)
             {
                 Vector3 local_up =
-                    up_vector.slide(center_points[i].tangent_next).normalized();
+                    settings.up_vector.slide(center_points[i].tangent_next)
+                        .normalized();
                 binormal = tangent_avg.cross(local_up);
             }
             else
@@ -411,7 +1638,7 @@ void CurveMesh::_generate_edge_vertices(
             }
             binormal.normalize();
             binormal = binormal.rotated(tangent_avg, center_points[i].tilt);
-            spoke = binormal * width * local_width * 0.5f;
+            spoke = binormal * settings.width * local_width * 0.5f;
 
             width_correction = Math::sqrt(2.0f / (1.0f + corner_cosine));
             width_correction_dir =
@@ -425,26 +1652,32 @@ void CurveMesh::_generate_edge_vertices(
         }
 
         float v_offset = 0.5f;
-        if (scale_uv_by_width)
+        if (settings.scale_uv_by_width)
         {
             v_offset *= local_width;
         }
 
         EdgePoint base_point;
         Vector3 tangent = tangent_avg;
-        if (!smooth_shaded_corners && center_points[i].corner_point)
+        if (!settings.smooth_shaded_corners && center_points[i].corner_point)
         {
             tangent = center_points[i].tangent_prev;
         }
 
         Vector3 normal = -tangent.cross(binormal).normalized();
-        if (add_uv2)
+        const Vector3 profile_up =
+            (PROFILE == PROFILE_CUSTOM)
+                ? -tangent_avg.cross(binormal).normalized()
+                : normal;
+        if (ADD_UV2)
         {
-            base_point.uv2.x = padding_h + u * length_h;
+            base_point.uv2.x = padding_h + span_u * length_h;
         }
-        if (scale_uv_by_length)
+        base_point.offset = u;
+        base_point.center = center_points[i].position;
+        if (settings.scale_uv_by_length)
         {
-            u *= total_length;
+            u *= uv_length;
         }
         base_point.uv.x = u;
         base_point.tangent = tangent;
@@ -452,30 +1685,54 @@ void CurveMesh::_generate_edge_vertices(
         for (int e = 0; e < edge_count; e++)
         {
             int edge = e * 2 - 1;
-            for (int j = 0; j < radial_segments; j++)
+            const Vector3 edge_spoke = edge * spoke;
+            const Vector3 edge_spoke_side = tangent_avg.cross(edge_spoke);
+            const Vector3 edge_normal = (PROFILE == PROFILE_TUBE)
+                                            ? -edge * normal.cross(tangent)
+                                            : normal;
+            const Vector3 edge_normal_side = tangent.cross(edge_normal);
+            for (int j = 0; j < ring_size; j++)
             {
                 EdgePoint point = base_point;
-                if (!zero_width)
+                if (!ZERO_WIDTH)
                 {
-                    float angle = j * segment_angle;
-                    Vector3 spoke_rotated = spoke.rotated(tangent_avg, angle);
+                    Vector3 offset;
+                    if (PROFILE == PROFILE_CUSTOM)
+                    {
+                        const Vector2 &shape_point =
+                            settings.profile_template.positions[j];
+                        offset = (binormal * shape_point.x +
+                                  profile_up * shape_point.y) *
+                                 (settings.width * local_width);
+                    }
+                    else
+                    {
+                        offset = edge_spoke * rotations[j].x +
+                                 edge_spoke_side * rotations[j].y;
+                    }
 
                     Vector3 stretched_component =
-                        spoke_rotated.dot(width_correction_dir) *
+                        offset.dot(width_correction_dir) *
                         width_correction_dir;
-                    Vector3 fixed_component =
-                        spoke_rotated - stretched_component;
-                    spoke_rotated = width_correction * stretched_component +
-                                    fixed_component;
-
-                    point.position =
-                        center_points[i].position + edge * spoke_rotated;
-
-                    Vector3 normal_rotated = (profile == PROFILE_TUBE)
-                                                 ? -edge * normal.cross(tangent)
-                                                 : normal;
-                    normal_rotated = normal_rotated.rotated(tangent, angle);
-                    point.normal = normal_rotated;
+                    Vector3 fixed_component = offset - stretched_component;
+                    offset = width_correction * stretched_component +
+                             fixed_component;
+
+                    point.position = center_points[i].position + offset;
+
+                    if (PROFILE == PROFILE_CUSTOM)
+                    {
+                        const Vector2 &shape_normal =
+                            settings.profile_template.normals[j];
+                        point.normal = (binormal * shape_normal.x +
+                                        normal * shape_normal.y)
+                                           .normalized();
+                    }
+                    else
+                    {
+                        point.normal = edge_normal * rotations[j].x +
+                                       edge_normal_side * rotations[j].y;
+                    }
                 }
                 else
                 {
@@ -483,28 +1740,34 @@ void CurveMesh::_generate_edge_vertices(
                     point.normal = normal;
                 }
 
-                if (profile == PROFILE_CROSS && tile_segment_uv)
+                if (PROFILE == PROFILE_TUBE)
                 {
-                    point.uv.y = (e + j) * length_v;
+                    point.uv.y = j * length_v;
+                }
+                else if (PROFILE == PROFILE_CUSTOM)
+                {
+                    point.uv.y = settings.profile_template.v[j];
                 }
-                else if (profile == PROFILE_TUBE)
+                else if (tile_cross_uv)
                 {
-                    point.uv.y = j * length_v;
+                    point.uv.y = (e + j) * length_v;
                 }
                 else
                 {
                     point.uv.y = 0.5f + edge * v_offset;
                 }
 
-                if (add_uv2)
+                if (ADD_UV2)
                 {
-                    point.uv2.y = e * edge_padding + j * length_v;
+                    point.uv2.y = (PROFILE == PROFILE_CUSTOM)
+                                      ? settings.profile_template.v[j]
+                                      : e * edge_padding + j * length_v;
                 }
 
                 int index = edge_points.size();
-                if (index >= radial_segments)
+                if (index >= ring_size)
                 {
-                    point.prev_point = index - radial_segments;
+                    point.prev_point = index - ring_size;
                     edge_points[point.prev_point].next_point = index;
                 }
 
@@ -514,7 +1777,7 @@ void CurveMesh::_generate_edge_vertices(
             }
         }
 
-        if (!smooth_shaded_corners && center_points[i].corner_point)
+        if (!settings.smooth_shaded_corners && center_points[i].corner_point)
         {
             tangent = center_points[i].tangent_next;
             normal = -tangent.cross(binormal).normalized();
@@ -522,20 +1785,31 @@ void CurveMesh::_generate_edge_vertices(
             for (int e = 0; e < edge_count; e++)
             {
                 int edge = e * 2 - 1;
-                for (int j = 0; j < radial_segments; j++)
+                const Vector3 edge_normal = (PROFILE == PROFILE_TUBE)
+                                                ? -edge * normal.cross(tangent)
+                                                : normal;
+                const Vector3 edge_normal_side = tangent.cross(edge_normal);
+                for (int j = 0; j < ring_size; j++)
                 {
                     int duplicated_index =
-                        edge_points.size() - radial_segments * edge_count;
+                        edge_points.size() - ring_size * edge_count;
                     EdgePoint point = edge_points[duplicated_index];
                     point.tangent = tangent;
-                    Vector3 normal_rotated = (profile == PROFILE_TUBE)
-                                                 ? -edge * normal.cross(tangent)
-                                                 : normal;
-                    normal_rotated = normal_rotated.rotated(
-                        tangent, (float)j * segment_angle);
-                    point.normal = normal_rotated;
+                    if (PROFILE == PROFILE_CUSTOM)
+                    {
+                        const Vector2 &shape_normal =
+                            settings.profile_template.normals[j];
+                        point.normal = (binormal * shape_normal.x +
+                                        normal * shape_normal.y)
+                                           .normalized();
+                    }
+                    else
+                    {
+                        point.normal = edge_normal * rotations[j].x +
+                                       edge_normal_side * rotations[j].y;
+                    }
                     int index = edge_points.size();
-                    point.prev_point = index - radial_segments;
+                    point.prev_point = index - ring_size;
                     edge_points[point.prev_point].next_point = index;
                     edge_points[duplicated_index].next_connected = false;
                     point.prev_connected = false;
@@ -545,24 +1819,151 @@ void CurveMesh::_generate_edge_vertices(
         }
     }
 
-    for (int j = 0; j < radial_segments; j++)
+    for (int j = 0; j < ring_size; j++)
     {
-        int last_index = edge_points.size() - radial_segments + j;
+        int last_index = edge_points.size() - ring_size + j;
         edge_points[last_index].next_point = j;
         edge_points[j].prev_point = last_index;
-        if (!curve->is_closed())
+        if (!closed)
         {
             for (int e = 0; e < edge_count; e++)
             {
-                int base = e * radial_segments;
+                int base = e * ring_size;
                 edge_points[j + base].prev_connected = false;
-                edge_points[last_index - (edge_count - 1 - e) * radial_segments]
+                edge_points[last_index - (edge_count - 1 - e) * ring_size]
                     .next_connected = false;
             }
         }
     }
 }
 
+template <bool ZERO_WIDTH, bool ADD_UV2>
+CurveMesh::EdgeVertexKernel
+CurveMesh::_get_edge_vertex_kernel(Profile profile, int radial_segments) const
+{
+    switch (profile)
+    {
+    case PROFILE_CROSS:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_CROSS, 0, ZERO_WIDTH, ADD_UV2>;
+    case PROFILE_CUSTOM:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_CUSTOM, 0, ZERO_WIDTH, ADD_UV2>;
+    case PROFILE_TUBE:
+        break;
+    default:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_FLAT, 0, ZERO_WIDTH, ADD_UV2>;
+    }
+
+    // Common tube resolutions get a fixed ring size, so the ring loop can be
+    // unrolled. A zero width tube collapses to a line and gains nothing.
+    switch (ZERO_WIDTH ? 0 : radial_segments)
+    {
+    case 4:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 4, ZERO_WIDTH, ADD_UV2>;
+    case 6:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 6, ZERO_WIDTH, ADD_UV2>;
+    case 8:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 8, ZERO_WIDTH, ADD_UV2>;
+    case 12:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 12, ZERO_WIDTH, ADD_UV2>;
+    case 16:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 16, ZERO_WIDTH, ADD_UV2>;
+    default:
+        return &CurveMesh::_generate_edge_vertices_kernel<
+            PROFILE_TUBE, 0, ZERO_WIDTH, ADD_UV2>;
+    }
+}
+
+void CurveMesh::_generate_edge_vertices(
+    LocalVector<CenterPoint> &center_points, real_t total_length,
+    int radial_segments, const GenerationSettings &settings, bool closed,
+    LocalVector<EdgePoint> &edge_points) const
+{
+    // Profile, width and UV2 are fixed for the whole rebuild, so the kernel
+    // is picked once here instead of branching for every vertex.
+    const bool zero_width = Math::is_zero_approx(settings.width);
+    EdgeVertexKernel kernel;
+    if (zero_width)
+    {
+        kernel = settings.add_uv2
+                     ? _get_edge_vertex_kernel<true, true>(
+                           settings.profile, radial_segments)
+                     : _get_edge_vertex_kernel<true, false>(
+                           settings.profile, radial_segments);
+    }
+    else
+    {
+        kernel = settings.add_uv2
+                     ? _get_edge_vertex_kernel<false, true>(
+                           settings.profile, radial_segments)
+                     : _get_edge_vertex_kernel<false, false>(
+                           settings.profile, radial_segments);
+    }
+
+    if (settings.span_length > 0.0f && settings.follow_curve && !closed &&
+        !zero_width)
+    {
+        _anchor_span_frame(center_points, total_length, settings);
+    }
+
+    (this->*kernel)(center_points, total_length, radial_segments, settings,
+                    closed, edge_points);
+}
+
+void CurveMesh::_anchor_span_frame(LocalVector<CenterPoint> &center_points,
+                                   real_t total_length,
+                                   const GenerationSettings &settings) const
+{
+    // The transported frame starts out aligned with up_vector, but where it
+    // ends up depends on the whole span, so the next span would start with
+    // a twist. Running the transport once here and spreading the leftover
+    // angle over the tilts makes the span end aligned with up_vector too.
+    const int point_count = center_points.size();
+    if (point_count < 2 || total_length <= 0.0f)
+    {
+        return;
+    }
+
+    const Vector3 up_vector_normalized = settings.up_vector.normalized();
+    Vector3 current_up = up_vector_normalized;
+    Vector3 binormal;
+    Vector3 tangent_avg;
+    for (const CenterPoint &center_point : center_points)
+    {
+        tangent_avg =
+            (center_point.tangent_next + center_point.tangent_prev)
+                .normalized();
+        binormal = tangent_avg.cross(current_up);
+        current_up = binormal.cross(tangent_avg);
+    }
+
+    Vector3 anchor = tangent_avg.cross(up_vector_normalized);
+    if (anchor.is_zero_approx() || binormal.is_zero_approx())
+    {
+        // The span ends along up_vector, which gives no direction to align
+        // with.
+        return;
+    }
+    anchor.normalize();
+    binormal.normalize();
+
+    const float twist = Math::atan2(tangent_avg.dot(binormal.cross(anchor)),
+                                    binormal.dot(anchor));
+    for (CenterPoint &center_point : center_points)
+    {
+        const float share = CLAMP(center_point.partial_length / total_length,
+                                  0.0f, 1.0f);
+        center_point.tilt += twist * share;
+    }
+}
+
 void CurveMesh::_interleave_edge_vertices(
     LocalVector<EdgePoint> &edge_points,
     LocalVector<CenterPoint> &center_points, int radial_segments) const
@@ -601,7 +2002,8 @@ void CurveMesh::_interleave_edge_vertices(
 
 void CurveMesh::_filter_overlapping_vertices(
     LocalVector<EdgePoint> &edge_points,
-    LocalVector<CenterPoint> &center_points, int radial_segments) const
+    LocalVector<CenterPoint> &center_points, int radial_segments,
+    const GenerationSettings &settings, bool closed) const
 {
     auto remove_point = [&edge_points](EdgePoint &point)
     {
@@ -623,7 +2025,7 @@ void CurveMesh::_filter_overlapping_vertices(
 
             while (point_index > last_index)
             {
-                if (next_index < point_index && !curve->is_closed())
+                if (next_index < point_index && !closed)
                 {
                     break;
                 }
@@ -639,7 +2041,7 @@ void CurveMesh::_filter_overlapping_vertices(
                         next_point->filter = true;
                     }
 
-                    if (profile == PROFILE_TUBE)
+                    if (settings.profile == PROFILE_TUBE)
                     {
                         const EdgePoint *top_point =
                             &edge_points[point_index - j +
@@ -853,166 +2255,970 @@ void CurveMesh::_filter_overlapping_vertices(
 
                     kept_point->filter = false;
 
-                    for (uint32_t i = 1; i < group_indices.size(); ++i)
-                    {
-                        EdgePoint *remove_candidate =
-                            &edge_points[group_indices[i]];
-                        remove_point(*remove_candidate);
-                        remove_candidate->removed = true;
-                        remove_candidate->filter = false;
-                        points_removed = true;
-                    }
-                }
-                else
-                {
-                    remove_point(*point);
-                    point->removed = true;
-                    point->filter = false;
-                    points_removed = true;
-                }
+                    for (uint32_t i = 1; i < group_indices.size(); ++i)
+                    {
+                        EdgePoint *remove_candidate =
+                            &edge_points[group_indices[i]];
+                        remove_point(*remove_candidate);
+                        remove_candidate->removed = true;
+                        remove_candidate->filter = false;
+                        points_removed = true;
+                    }
+                }
+                else
+                {
+                    remove_point(*point);
+                    point->removed = true;
+                    point->filter = false;
+                    points_removed = true;
+                }
+            }
+        }
+    }
+}
+
+void CurveMesh::_mark_distant_overlaps(
+    LocalVector<EdgePoint> &edge_points,
+    const LocalVector<CenterPoint> &center_points, real_t total_length,
+    int radial_segments, const GenerationSettings &settings,
+    bool closed) const
+{
+    // The local test in _filter_overlapping_vertices only compares
+    // neighbouring rings. This finds edge points buried inside a distant part
+    // of the curve, where the path crosses or touches itself, and marks them
+    // for the same merge pass. Only closed profiles have an inside.
+    if (settings.profile != PROFILE_TUBE &&
+        !(settings.profile == PROFILE_CUSTOM && settings.profile_closed))
+    {
+        return;
+    }
+
+    const int center_count = center_points.size();
+    const int segment_count = closed ? center_count : center_count - 1;
+    if (segment_count < 1 || radial_segments < 3)
+    {
+        return;
+    }
+
+    // The outer radius of a ring bounds the swept volume. The inner radius
+    // is the distance under which a point is inside the ring's polygon.
+    LocalVector<float> outer_radii;
+    LocalVector<float> inner_radii;
+    outer_radii.resize(center_count);
+    inner_radii.resize(center_count);
+    for (int i = 0; i < center_count; i++)
+    {
+        outer_radii[i] = 0.0f;
+        inner_radii[i] = Math_INF;
+    }
+    for (const EdgePoint &point : edge_points)
+    {
+        if (point.removed)
+        {
+            continue;
+        }
+        const int source = point.source_index;
+        const float radius =
+            point.position.distance_to(center_points[source].position);
+        outer_radii[source] = Math::max(outer_radii[source], radius);
+        inner_radii[source] = Math::min(inner_radii[source], radius);
+    }
+
+    const float inscribed = Math::cos(Math_PI / radial_segments);
+    float max_radius = 0.0f;
+    for (int i = 0; i < center_count; i++)
+    {
+        inner_radii[i] =
+            (inner_radii[i] < Math_INF) ? inner_radii[i] * inscribed : 0.0f;
+        max_radius = Math::max(max_radius, outer_radii[i]);
+    }
+    if (max_radius <= 0.0f)
+    {
+        return;
+    }
+
+    // Cells are at least as wide as the thickest ring, so a segment piece
+    // covers a few cells at most, and no narrower than half the average
+    // segment, so long segments are not split into many pieces.
+    const float cell_size = Math::max(
+        2.0f * max_radius, (float)total_length / (2.0f * segment_count));
+    const float cell_scale = 1.0f / cell_size;
+    auto get_cell = [cell_scale](const Vector3 &p_position)
+    {
+        const Vector3 cell = (p_position * cell_scale).floor();
+        return Vector3i(cell.x, cell.y, cell.z);
+    };
+
+    HashMap<Vector3i, LocalVector<int>> cells;
+    for (int i = 0; i < segment_count; i++)
+    {
+        const int next = (i + 1) % center_count;
+        const Vector3 &from = center_points[i].position;
+        const Vector3 &to = center_points[next].position;
+        const float radius = Math::max(outer_radii[i], outer_radii[next]);
+        const Vector3 extent(radius, radius, radius);
+        const int pieces =
+            Math::max(1, (int)Math::ceil(from.distance_to(to) * cell_scale));
+        for (int k = 0; k < pieces; k++)
+        {
+            const Vector3 a = from.lerp(to, (float)k / pieces);
+            const Vector3 b = from.lerp(to, (float)(k + 1) / pieces);
+            const Vector3i begin = get_cell(a.min(b) - extent);
+            const Vector3i end = get_cell(a.max(b) + extent);
+            for (int x = begin.x; x <= end.x; x++)
+            {
+                for (int y = begin.y; y <= end.y; y++)
+                {
+                    for (int z = begin.z; z <= end.z; z++)
+                    {
+                        LocalVector<int> &cell = cells[Vector3i(x, y, z)];
+                        if (cell.is_empty() || cell[cell.size() - 1] != i)
+                        {
+                            cell.push_back(i);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    for (EdgePoint &point : edge_points)
+    {
+        if (point.removed || point.filter)
+        {
+            continue;
+        }
+
+        const LocalVector<int> *cell = cells.getptr(get_cell(point.position));
+        if (cell == nullptr)
+        {
+            continue;
+        }
+
+        const int source = point.source_index;
+        const float offset = center_points[source].partial_length;
+        for (const int i : *cell)
+        {
+            const int next = (i + 1) % center_count;
+            const float begin_offset = center_points[i].partial_length;
+            const float end_offset =
+                (next > i) ? center_points[next].partial_length : total_length;
+            auto get_gap = [&](float p_offset)
+            {
+                return Math::max(begin_offset - p_offset,
+                                 p_offset - end_offset);
+            };
+            float gap = get_gap(offset);
+            if (closed)
+            {
+                gap = Math::min(gap, Math::min(get_gap(offset + total_length),
+                                               get_gap(offset - total_length)));
+            }
+
+            // Rings this close along the curve are neighbours, which the
+            // local test already handles.
+            const float segment_radius =
+                Math::max(outer_radii[i], outer_radii[next]);
+            if (gap <= outer_radii[source] + segment_radius)
+            {
+                continue;
+            }
+
+            const Vector3 &from = center_points[i].position;
+            const Vector3 segment = center_points[next].position - from;
+            const float length_squared = segment.length_squared();
+            const float t =
+                (length_squared > 0.0f)
+                    ? Math::clamp((point.position - from).dot(segment) /
+                                      length_squared,
+                                  0.0f, 1.0f)
+                    : 0.0f;
+            const float radius =
+                Math::lerp(inner_radii[i], inner_radii[next], t);
+            if (point.position.distance_squared_to(from + segment * t) <
+                radius * radius)
+            {
+                point.filter = true;
+                break;
+            }
+        }
+    }
+}
+
+void CurveMesh::_generate_vertices(LocalVector<EdgePoint> &edge_points,
+                                   const GenerationSettings &settings,
+                                   bool closed, VertexArrays &arrays,
+                                   AABB &aabb) const
+{
+    const bool add_uv2 = settings.add_uv2;
+    const int bone_count = settings.skin_bone_count;
+    auto add_point = [&](const EdgePoint &edge_point)
+    {
+        arrays.points.push_back(edge_point.position);
+        arrays.normals.push_back(edge_point.normal);
+        arrays.uvs.push_back(edge_point.uv);
+        if (add_uv2)
+        {
+            arrays.uv2s.push_back(edge_point.uv2);
+        }
+        arrays.tangents.push_back(edge_point.tangent.x);
+        arrays.tangents.push_back(edge_point.tangent.y);
+        arrays.tangents.push_back(edge_point.tangent.z);
+        arrays.tangents.push_back(1.0f);
+        if (bone_count > 0)
+        {
+            _add_skin_weights(edge_point.offset, bone_count, closed,
+                              arrays.bones, arrays.weights);
+        }
+        if (settings.add_shader_channels)
+        {
+            _add_shader_channels(edge_point.offset,
+                                 edge_point.position - edge_point.center,
+                                 edge_point.normal, arrays.custom0,
+                                 arrays.custom1);
+        }
+    };
+
+    // Bounds are accumulated while the vertices are written, so callers get
+    // the surface AABB without another pass over the vertex array.
+    for (uint32_t k = 0; k < edge_points.size(); ++k)
+    {
+        EdgePoint *point = &edge_points[k];
+        if (!point->removed)
+        {
+            if (arrays.points.is_empty())
+            {
+                aabb = AABB(point->position, Vector3());
+            }
+            else
+            {
+                aabb.expand_to(point->position);
+            }
+            point->source_index = arrays.points.size();
+            add_point(*point);
+        }
+    }
+}
+
+int CurveMesh::_cull_degenerate_triangles(PackedInt32Array &indices,
+                                          float area_threshold,
+                                          VertexArrays &arrays,
+                                          AABB &aabb) const
+{
+    // Rings where the width reaches zero collapse onto the centerline, so
+    // the faces spanning them have no area; overlap filtering can leave
+    // slivers as well. The cross product is twice the triangle area.
+    const float cross_threshold = 2.0f * Math::max(area_threshold, 0.0f);
+    const float cross_threshold_sq = cross_threshold * cross_threshold;
+    const Vector3 *point_data = arrays.points.ptr();
+    int *index_data = indices.ptrw();
+    const int index_count = indices.size();
+
+    int write = 0;
+    for (int i = 0; i + 2 < index_count; i += 3)
+    {
+        const int a = index_data[i];
+        const int b = index_data[i + 1];
+        const int c = index_data[i + 2];
+        const Vector3 cross = (point_data[b] - point_data[a])
+                                  .cross(point_data[c] - point_data[a]);
+        if (a == b || b == c || c == a ||
+            cross.length_squared() <= cross_threshold_sq)
+        {
+            continue;
+        }
+        index_data[write++] = a;
+        index_data[write++] = b;
+        index_data[write++] = c;
+    }
+
+    const int culled = (index_count - write) / 3;
+    if (culled == 0)
+    {
+        return 0;
+    }
+    indices.resize(write);
+    index_data = indices.ptrw();
+
+    // Drop the vertices no remaining face uses, keeping the original order
+    // so the rest of the buffer stays ring by ring.
+    const int vertex_count = arrays.points.size();
+    LocalVector<int> remap;
+    remap.resize(vertex_count);
+    for (int v = 0; v < vertex_count; v++)
+    {
+        remap[v] = -1;
+    }
+    for (int i = 0; i < write; i++)
+    {
+        remap[index_data[i]] = 0;
+    }
+
+    int kept = 0;
+    for (int v = 0; v < vertex_count; v++)
+    {
+        if (remap[v] < 0)
+        {
+            continue;
+        }
+        remap[v] = kept;
+        if (kept == 0)
+        {
+            aabb = AABB(point_data[v], Vector3());
+        }
+        else
+        {
+            aabb.expand_to(point_data[v]);
+        }
+        kept++;
+    }
+    if (kept == 0)
+    {
+        // The bounds written with the vertices no longer cover anything.
+        aabb = AABB();
+    }
+
+    if (kept != vertex_count)
+    {
+        _compact_vertex_array(arrays.points, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.normals, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.tangents, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.uvs, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.uv2s, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.bones, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.weights, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.custom0, remap, vertex_count, kept);
+        _compact_vertex_array(arrays.custom1, remap, vertex_count, kept);
+        for (int i = 0; i < write; i++)
+        {
+            index_data[i] = remap[index_data[i]];
+        }
+    }
+
+    return culled;
+}
+
+void CurveMesh::_compact_edge_points(const LocalVector<EdgePoint> &edge_points,
+                                     int radial_segments, int edge_count,
+                                     CompactColumns &columns) const
+{
+    // A column's linked list always visits its surviving points in index
+    // order, so the survivors of column j are exactly the unremoved points
+    // with index % radial_segments == j. A counting sort by column rewrites
+    // them into dense arrays without chasing any links.
+    const int ring_size = radial_segments * edge_count;
+
+    columns.offsets.resize(radial_segments + 1);
+    for (int j = 0; j <= radial_segments; j++)
+    {
+        columns.offsets[j] = 0;
+    }
+    for (uint32_t k = 0; k < edge_points.size(); ++k)
+    {
+        columns.offsets[k % radial_segments + 1] += !edge_points[k].removed;
+    }
+    for (int j = 0; j < radial_segments; j++)
+    {
+        columns.offsets[j + 1] += columns.offsets[j];
+    }
+
+    LocalVector<int> fill;
+    fill.resize(radial_segments);
+    for (int j = 0; j < radial_segments; j++)
+    {
+        fill[j] = columns.offsets[j];
+    }
+
+    columns.points.resize(columns.offsets[radial_segments]);
+    for (uint32_t k = 0; k < edge_points.size(); ++k)
+    {
+        const EdgePoint &edge_point = edge_points[k];
+        if (edge_point.removed)
+        {
+            continue;
+        }
+        ColumnPoint &point = columns.points[fill[k % radial_segments]++];
+        point.vertex = edge_point.source_index;
+        point.ring = k / ring_size;
+        point.edge = edge_point.edge;
+        point.prev_connected = edge_point.prev_connected;
+        point.next_connected = edge_point.next_connected;
+    }
+}
+
+void CurveMesh::_generate_triangles(const CompactColumns &columns,
+                                    int radial_segments, int edge_count,
+                                    PackedInt32Array &indices) const
+{
+    if (edge_count == 2)
+    {
+        for (int j = 0; j < radial_segments; j++)
+        {
+            const ColumnPoint *column = &columns.points[columns.offsets[j]];
+            const int count = columns.offsets[j + 1] - columns.offsets[j];
+
+            // Start right after the first switch between the two edges, so
+            // both edges already have a previous point.
+            int start = 1;
+            while (start < count && column[start].edge == column[0].edge)
+            {
+                start++;
+            }
+            if (start >= count)
+            {
+                continue;
+            }
+
+            const ColumnPoint *last_edge_point[2];
+            last_edge_point[column[start - 1].edge] = &column[start - 1];
+            last_edge_point[column[start].edge] = &column[start];
+
+            for (int t = 1; t <= count; t++)
+            {
+                int p = start + t;
+                p -= (p >= count) ? count : 0;
+                const ColumnPoint *point = &column[p];
+
+                const bool face_connected =
+                    (last_edge_point[0]->next_connected ||
+                     last_edge_point[1]->next_connected) &&
+                    (point->prev_connected ||
+                     last_edge_point[1 - point->edge]->prev_connected);
+
+                if (face_connected)
+                {
+                    indices.push_back(last_edge_point[1]->vertex);
+                    indices.push_back(last_edge_point[0]->vertex);
+                    indices.push_back(point->vertex);
+                }
+
+                last_edge_point[point->edge] = point;
+            }
+        }
+        return;
+    }
+
+    // Each column is merged against its two neighbours independently and
+    // writes into its own grid cells; a final sequential pass then emits the
+    // cells ring by ring, matching the original traversal order.
+    int ring_count = 0;
+    for (int j = 0; j < radial_segments; j++)
+    {
+        const int count = columns.offsets[j + 1] - columns.offsets[j];
+        if (count == 0)
+        {
+            return;
+        }
+        ring_count = Math::max(
+            ring_count, columns.points[columns.offsets[j + 1] - 1].ring + 1);
+    }
+
+    if (_stamp_ring_triangles(columns, radial_segments, ring_count, indices))
+    {
+        return;
+    }
+
+    const int cell_count = ring_count * radial_segments;
+    LocalVector<int> cell_indices;
+    LocalVector<uint8_t> cell_faces;
+    cell_indices.resize(cell_count * 6);
+    cell_faces.resize(cell_count);
+    for (int cell = 0; cell < cell_count; cell++)
+    {
+        cell_faces[cell] = 0;
+    }
+
+    for (int j = 0; j < radial_segments; j++)
+    {
+        const int top_j = (j + 1) % radial_segments;
+        const int bottom_j = (j + radial_segments - 1) % radial_segments;
+
+        const ColumnPoint *column = &columns.points[columns.offsets[j]];
+        const ColumnPoint *top_column =
+            &columns.points[columns.offsets[top_j]];
+        const ColumnPoint *bottom_column =
+            &columns.points[columns.offsets[bottom_j]];
+        const int count = columns.offsets[j + 1] - columns.offsets[j];
+        const int top_count =
+            columns.offsets[top_j + 1] - columns.offsets[top_j];
+        const int bottom_count =
+            columns.offsets[bottom_j + 1] - columns.offsets[bottom_j];
+
+        // top: last point of the next column at or before this ring.
+        // bottom: first point of the previous column at or after the ring
+        // of the next point. Both wrap around the column.
+        // Custom profiles may leave gaps between neighbouring columns at
+        // open ends and hard corners.
+        const bool top_connected =
+            columns.connected.is_empty() || columns.connected[j];
+        const bool bottom_connected =
+            columns.connected.is_empty() || columns.connected[bottom_j];
+
+        int top = -1;
+        int bottom = 0;
+        for (int p = 0; p < count; p++)
+        {
+            const ColumnPoint &point = column[p];
+            const bool wraps = (p + 1 == count);
+            const ColumnPoint &next_point = column[wraps ? 0 : p + 1];
+
+            while (top + 1 < top_count &&
+                   top_column[top + 1].ring <= point.ring)
+            {
+                top++;
+            }
+            const ColumnPoint &top_point =
+                top_column[top >= 0 ? top : top_count - 1];
+
+            if (wraps)
+            {
+                bottom = 0;
+            }
+            while (bottom < bottom_count &&
+                   bottom_column[bottom].ring < next_point.ring)
+            {
+                bottom++;
+            }
+            const ColumnPoint &bottom_point =
+                bottom_column[bottom < bottom_count ? bottom : 0];
+
+            const int cell = point.ring * radial_segments + j;
+            int *cell_index = &cell_indices[cell * 6];
+            uint8_t faces = 0;
+            if (top_connected &&
+                (next_point.prev_connected || top_point.next_connected))
+            {
+                cell_index[0] = point.vertex;
+                cell_index[1] = next_point.vertex;
+                cell_index[2] = top_point.vertex;
+                faces |= 1;
+            }
+            if (bottom_connected &&
+                (point.next_connected || bottom_point.prev_connected))
+            {
+                cell_index[3] = point.vertex;
+                cell_index[4] = bottom_point.vertex;
+                cell_index[5] = next_point.vertex;
+                faces |= 2;
             }
+            cell_faces[cell] = faces;
         }
     }
-}
 
-void CurveMesh::_generate_triangles(
-    LocalVector<EdgePoint> &edge_points, int radial_segments,
-    PackedVector3Array &points, PackedVector3Array &normals,
-    PackedFloat32Array &tangents, PackedVector2Array &uvs,
-    PackedVector2Array &uv2s, PackedInt32Array &indices) const
-{
-    const bool add_uv2 = get_add_uv2();
-    auto add_point = [&](const EdgePoint &edge_point)
+    for (int cell = 0; cell < cell_count; cell++)
     {
-        points.push_back(edge_point.position);
-        normals.push_back(edge_point.normal);
-        uvs.push_back(edge_point.uv);
-        if (add_uv2)
+        const int *cell_index = &cell_indices[cell * 6];
+        if (cell_faces[cell] & 1)
         {
-            uv2s.push_back(edge_point.uv2);
+            indices.push_back(cell_index[0]);
+            indices.push_back(cell_index[1]);
+            indices.push_back(cell_index[2]);
         }
-        tangents.push_back(edge_point.tangent.x);
-        tangents.push_back(edge_point.tangent.y);
-        tangents.push_back(edge_point.tangent.z);
-        tangents.push_back(1.0f);
-    };
+        if (cell_faces[cell] & 2)
+        {
+            indices.push_back(cell_index[3]);
+            indices.push_back(cell_index[4]);
+            indices.push_back(cell_index[5]);
+        }
+    }
+}
 
-    for (uint32_t k = 0; k < edge_points.size(); ++k)
+bool CurveMesh::_stamp_ring_triangles(const CompactColumns &columns,
+                                      int radial_segments, int ring_count,
+                                      PackedInt32Array &indices) const
+{
+    // Without removed points every ring is numbered consecutively and
+    // joined to the next one by the same pattern, so the faces can be
+    // stamped from a template instead of merged column by column. This
+    // only holds while the connection flags are the same all around each
+    // ring; anything else takes the general path.
+    if ((int)columns.points.size() != ring_count * radial_segments)
     {
-        EdgePoint *point = &edge_points[k];
-        if (!point->removed)
+        return false;
+    }
+
+    LocalVector<uint8_t> ring_linked;
+    ring_linked.resize(ring_count);
+    for (int r = 0; r < ring_count; r++)
+    {
+        const int next_r = (r + 1 == ring_count) ? 0 : r + 1;
+        const ColumnPoint &first = columns.points[r];
+        const ColumnPoint &first_next = columns.points[next_r];
+        for (int j = 0; j < radial_segments; j++)
         {
-            point->source_index = points.size();
-            add_point(*point);
+            const ColumnPoint &point =
+                columns.points[columns.offsets[j] + r];
+            const ColumnPoint &next_point =
+                columns.points[columns.offsets[j] + next_r];
+            if (point.vertex != r * radial_segments + j ||
+                point.next_connected != first.next_connected ||
+                next_point.prev_connected != first_next.prev_connected)
+            {
+                return false;
+            }
         }
+        ring_linked[r] = first.next_connected || first_next.prev_connected;
     }
 
-    if (profile != PROFILE_TUBE)
+    // Faces between ring r and r + 1, as offsets from the first vertex of
+    // ring r, in the order the general path emits them.
+    LocalVector<int> pattern;
+    pattern.reserve(radial_segments * 6);
+    for (int j = 0; j < radial_segments; j++)
     {
-        for (int j = 0; j < radial_segments; j++)
+        const int top_j = (j + 1) % radial_segments;
+        const int bottom_j = (j + radial_segments - 1) % radial_segments;
+        if (columns.connected.is_empty() || columns.connected[j])
+        {
+            pattern.push_back(j);
+            pattern.push_back(radial_segments + j);
+            pattern.push_back(top_j);
+        }
+        if (columns.connected.is_empty() || columns.connected[bottom_j])
         {
-            const EdgePoint *point = &edge_points[j];
-            const EdgePoint *last_edge_idx[2] = {nullptr, nullptr};
+            pattern.push_back(j);
+            pattern.push_back(radial_segments + bottom_j);
+            pattern.push_back(radial_segments + j);
+        }
+    }
 
-            int stop_index = point->next_point;
-            const EdgePoint *stop_point = &edge_points[stop_index];
+    int linked_count = 0;
+    for (int r = 0; r < ring_count; r++)
+    {
+        linked_count += ring_linked[r];
+    }
 
-            while (stop_point->edge == point->edge)
+    const int pattern_size = pattern.size();
+    const int start = indices.size();
+    indices.resize(start + linked_count * pattern_size);
+    int *write = indices.ptrw() + start;
+    const int *stamp = pattern.ptr();
+    for (int r = 0; r < ring_count; r++)
+    {
+        if (!ring_linked[r])
+        {
+            continue;
+        }
+        const int base = r * radial_segments;
+        if (r + 1 < ring_count)
+        {
+            for (int k = 0; k < pattern_size; k++)
             {
-                point = stop_point;
-                stop_index = point->next_point;
-                stop_point = &edge_points[stop_index];
+                write[k] = stamp[k] + base;
             }
-
-            last_edge_idx[point->edge] = point;
-            last_edge_idx[stop_point->edge] = stop_point;
-            point = stop_point;
-            int point_index;
-            do
+        }
+        else
+        {
+            // The last ring connects back to ring 0.
+            for (int k = 0; k < pattern_size; k++)
             {
-                point_index = point->next_point;
-                point = &edge_points[point_index];
+                write[k] = stamp[k] < radial_segments
+                               ? stamp[k] + base
+                               : stamp[k] - radial_segments;
+            }
+        }
+        write += pattern_size;
+    }
+    return true;
+}
 
-                bool skip_face = false;
+bool CurveMesh::_generate_triangle_strip(
+    const LocalVector<EdgePoint> &edge_points, int radial_segments,
+    int edge_count, PackedInt32Array &indices) const
+{
+    if (edge_count != 2)
+    {
+        return false;
+    }
 
-                if (!last_edge_idx[0]->next_connected &&
-                    !last_edge_idx[1]->next_connected)
-                {
-                    skip_face = true;
-                }
+    for (uint32_t k = 0; k < edge_points.size(); ++k)
+    {
+        if (edge_points[k].removed)
+        {
+            return false;
+        }
+    }
 
-                if (!point->prev_connected &&
-                    !last_edge_idx[1 - point->edge]->prev_connected)
-                {
-                    skip_face = true;
-                }
+    // Every ring holds both edges of each column, so a column is a regular
+    // two-row grid: alternating its edges yields the same triangles as
+    // _generate_triangles. Disconnected rings and separate columns are
+    // joined with degenerate triangles.
+    const int ring_size = radial_segments * 2;
+    const int ring_count = edge_points.size() / ring_size;
+    const bool wrap = edge_points[(ring_count - 1) * ring_size].next_connected;
+    int triangle_count = 0;
 
-                if (!skip_face)
-                {
-                    indices.push_back(last_edge_idx[1]->source_index);
-                    indices.push_back(last_edge_idx[0]->source_index);
-                    indices.push_back(point->source_index);
-                }
+    auto push_ring = [&](int ring, int column)
+    {
+        const int base = ring * ring_size + column;
+        indices.push_back(edge_points[base].source_index);
+        indices.push_back(edge_points[base + radial_segments].source_index);
+    };
 
-                last_edge_idx[point->edge] = &edge_points[point_index];
-            } while (point_index != stop_index);
-        }
-    }
-    else
+    for (int j = 0; j < radial_segments; j++)
     {
-        for (uint32_t i = 0; i < edge_points.size(); i += radial_segments)
+        int run_start = 0;
+        for (int r = 0; r < ring_count; r++)
         {
-            for (int j = 0; j < radial_segments; j++)
+            const bool run_ends =
+                r == ring_count - 1 ||
+                !edge_points[r * ring_size + j].next_connected;
+            if (!run_ends)
             {
-                int point_index = i + j;
-                const EdgePoint *point = &edge_points[point_index];
-                if (point->removed)
-                {
-                    continue;
-                }
-                EdgePoint *next_point = &edge_points[point->next_point];
-                EdgePoint *top_point =
-                    &edge_points[i + ((j + 1) % radial_segments)];
-                EdgePoint *bottom_point =
-                    &edge_points[point->next_point - j +
-                                 ((j + radial_segments - 1) % radial_segments)];
-
-                while (top_point->removed)
-                {
-                    top_point = &edge_points[top_point->prev_point];
-                }
+                continue;
+            }
 
-                if (next_point->prev_connected || top_point->next_connected)
+            const bool closing = wrap && r == ring_count - 1;
+            if (r > run_start || closing)
+            {
+                if (!indices.is_empty())
                 {
-                    indices.push_back(point->source_index);
-                    indices.push_back(next_point->source_index);
-                    indices.push_back(top_point->source_index);
+                    const int last = indices[indices.size() - 1];
+                    indices.push_back(last);
                 }
-
-                while (bottom_point->removed)
+                // The leading duplicate starts the run on an odd triangle,
+                // which keeps the winding of the triangle list. Every run
+                // has odd length, so this also holds after a join.
+                indices.push_back(
+                    edge_points[run_start * ring_size + j].source_index);
+                for (int ring = run_start; ring <= r; ring++)
                 {
-                    bottom_point = &edge_points[bottom_point->next_point];
+                    push_ring(ring, j);
                 }
-
-                if (point->next_connected || bottom_point->prev_connected)
+                if (closing)
                 {
-                    indices.push_back(point->source_index);
-                    indices.push_back(bottom_point->source_index);
-                    indices.push_back(next_point->source_index);
+                    push_ring(0, j);
                 }
+                triangle_count += (r - run_start + (closing ? 1 : 0)) * 2;
             }
+            run_start = r + 1;
         }
     }
+
+    // Frequent breaks at flat-shaded corners can make the joins cost more
+    // than the strip saves.
+    if (indices.size() >= triangle_count * 3)
+    {
+        indices.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void CurveMesh::_queue_update()
+{
+    finished_build_ready = false;
+    build_serial++;
+
+    CurveMeshScheduler *scheduler = CurveMeshScheduler::get_singleton();
+    if (use_scheduler && scheduler != nullptr &&
+        scheduler->queue_mesh(this))
+    {
+        return;
+    }
+    request_update();
+}
+
+void CurveMesh::_on_curve_changed()
+{
+    _queue_update();
+
+    // Builds that fit the budget stay synchronous and at full quality.
+    const uint64_t budget_usec =
+        (uint64_t)(Math::max(refinement_time_budget, 0.0f) * 1000.0f);
+    if (!progressive_refinement || use_scheduler ||
+        last_build_usec <= budget_usec)
+    {
+        return;
+    }
+
+    preview_requested = true;
+    last_change_msec = Time::get_singleton()->get_ticks_msec();
+    if (!refinement_timer_pending)
+    {
+        _schedule_refinement(refinement_delay);
+    }
+}
+
+void CurveMesh::_schedule_refinement(double p_delay)
+{
+    Engine *engine = Engine::get_singleton();
+    SceneTree *tree = Object::cast_to<SceneTree>(engine->get_main_loop());
+    if (tree == nullptr)
+    {
+        // Nothing would drive the refinement, so build at full quality.
+        preview_requested = false;
+        _queue_update();
+        return;
+    }
+
+    refinement_timer_pending = true;
+    tree->create_timer(p_delay)->connect(
+        "timeout", callable_mp(this, &CurveMesh::_on_refinement_timeout));
+}
+
+void CurveMesh::_on_refinement_timeout()
+{
+    refinement_timer_pending = false;
+
+    // Only one timer is pending at a time, so after further changes it is
+    // re-armed for the rest of the delay instead of refining right away.
+    const uint64_t delay_msec =
+        (uint64_t)(Math::max(refinement_delay, 0.0f) * 1000.0f);
+    const uint64_t elapsed_msec =
+        Time::get_singleton()->get_ticks_msec() - last_change_msec;
+    if (elapsed_msec < delay_msec)
+    {
+        _schedule_refinement((delay_msec - elapsed_msec) / 1000.0);
+        return;
+    }
+
+    _start_refinement();
+}
+
+void CurveMesh::_start_refinement()
+{
+    if (!generation_stats.preview)
+    {
+        return;
+    }
+
+    if (refinement_task >= 0)
+    {
+        // An outdated refinement is still running; try again once it is
+        // likely done rather than blocking on it.
+        _schedule_refinement(refinement_delay);
+        return;
+    }
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    if (!progressive_refinement || pool == nullptr)
+    {
+        _queue_update();
+        return;
+    }
+
+    prepare_build(refinement_build);
+    refinement_task =
+        pool->add_task(callable_mp(this, &CurveMesh::_run_refinement), false,
+                       "CurveMesh refinement");
+}
+
+void CurveMesh::_run_refinement()
+{
+    run_build(refinement_build);
+    callable_mp(this, &CurveMesh::_on_refinement_finished)
+        .call_deferred(refinement_build.serial);
+}
+
+void CurveMesh::_on_refinement_finished(uint32_t p_serial)
+{
+    if (refinement_task < 0 || p_serial != refinement_build.serial)
+    {
+        return;
+    }
+
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(
+        refinement_task);
+    refinement_task = -1;
+    commit_build(refinement_build);
+}
+
+void CurveMesh::_wait_for_refinement()
+{
+    CurveMeshScheduler *scheduler = CurveMeshScheduler::get_singleton();
+    if (scheduler != nullptr)
+    {
+        scheduler->wait_for_mesh(this);
+    }
+
+    if (refinement_task < 0)
+    {
+        return;
+    }
+
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(
+        refinement_task);
+    refinement_task = -1;
+    refinement_build = BackgroundBuild();
+    build_serial++;
+}
+
+CurveMesh::GenerationSettings CurveMesh::get_build_settings() const
+{
+    GenerationSettings settings = _get_generation_settings(false);
+    if (settings.width_curve.is_valid())
+    {
+        // The width curve may be edited while the worker samples it.
+        settings.width_curve = settings.width_curve->duplicate();
+    }
+    return settings;
+}
+
+void CurveMesh::prepare_build(BackgroundBuild &r_build) const
+{
+    r_build = BackgroundBuild();
+    r_build.serial = build_serial;
+    r_build.settings = get_build_settings();
+    _take_curve_snapshot(r_build.settings.tessellation_mode, r_build.snapshot);
+}
+
+void CurveMesh::run_build(BackgroundBuild &r_build) const
+{
+    CURVE_MESH_PROFILE_ZONE("CurveMesh::run_build");
+
+    bool triangle_strip = false;
+    const uint64_t begin_usec = Time::get_singleton()->get_ticks_usec();
+    r_build.end_rings[0].clear();
+    r_build.end_rings[1].clear();
+    r_build.arrays = _generate_mesh_arrays(
+        r_build.snapshot, r_build.settings, false, triangle_strip,
+        r_build.stats, r_build.aabb, r_build.end_rings);
+    r_build.usec = Time::get_singleton()->get_ticks_usec() - begin_usec;
+}
+
+bool CurveMesh::commit_build(BackgroundBuild &r_build)
+{
+    if (r_build.serial != build_serial)
+    {
+        r_build = BackgroundBuild();
+        return false;
+    }
+
+    last_build_usec = r_build.usec;
+    r_build.snapshot = CurveSnapshot();
+    r_build.settings = GenerationSettings();
+    finished_build = r_build;
+    finished_build_ready = true;
+    r_build = BackgroundBuild();
+    request_update();
+    return true;
 }
 
 void CurveMesh::_validate_property(PropertyInfo &p_property) const
 {
     static const StringName tessellation_tolerance_name(
         "tessellation_tolerance");
+    static const StringName decimation_tolerance_name("decimation_tolerance");
+    static const StringName degenerate_area_threshold_name(
+        "degenerate_area_threshold");
+    static const StringName filter_distant_overlaps_name(
+        "filter_distant_overlaps");
+    static const StringName curve_data_range_name("curve_data_range");
     static const StringName segments_name("segments");
     static const StringName tile_segment_uv_name("tile_segment_uv");
     static const StringName interleave_vertices_name("interleave_vertices");
     static const StringName scale_uv_by_width_name("scale_uv_by_width");
+    static const StringName profile_shape_name("profile_shape");
+    static const StringName profile_hard_corners_name("profile_hard_corners");
+    static const StringName profile_closed_name("profile_closed");
+    static const StringName refinement_delay_name("refinement_delay");
+    static const StringName refinement_time_budget_name(
+        "refinement_time_budget");
+    static const StringName preview_tessellation_tolerance_name(
+        "preview_tessellation_tolerance");
+    static const StringName preview_segments_name("preview_segments");
 
     const StringName &property_name = p_property.name;
 
@@ -1027,9 +3233,31 @@ void CurveMesh::_validate_property(PropertyInfo &p_property) const
             p_property.usage = PROPERTY_USAGE_NO_EDITOR;
         }
     }
+    else if (property_name == degenerate_area_threshold_name)
+    {
+        p_property.usage = cull_degenerate_triangles
+                               ? PROPERTY_USAGE_DEFAULT
+                               : PROPERTY_USAGE_NO_EDITOR;
+    }
+    else if (property_name == curve_data_range_name)
+    {
+        p_property.usage = curve_data.is_valid() ? PROPERTY_USAGE_DEFAULT
+                                                 : PROPERTY_USAGE_NO_EDITOR;
+    }
+    else if (property_name == filter_distant_overlaps_name)
+    {
+        p_property.usage = filter_overlaps ? PROPERTY_USAGE_DEFAULT
+                                           : PROPERTY_USAGE_NO_EDITOR;
+    }
+    else if (property_name == decimation_tolerance_name)
+    {
+        p_property.usage = (tessellation_mode != TESSELLATION_ADAPTIVE)
+                               ? PROPERTY_USAGE_DEFAULT
+                               : PROPERTY_USAGE_NO_EDITOR;
+    }
     else if (property_name == segments_name)
     {
-        if (profile == PROFILE_FLAT)
+        if (profile == PROFILE_FLAT || profile == PROFILE_CUSTOM)
         {
             p_property.usage = PROPERTY_USAGE_NO_EDITOR;
         }
@@ -1054,20 +3282,53 @@ void CurveMesh::_validate_property(PropertyInfo &p_property) const
     }
     else if (property_name == interleave_vertices_name)
     {
-        p_property.usage = (profile == PROFILE_TUBE) ? PROPERTY_USAGE_NO_EDITOR
-                                                     : PROPERTY_USAGE_DEFAULT;
+        p_property.usage = (_get_edge_count(profile) == 1)
+                               ? PROPERTY_USAGE_NO_EDITOR
+                               : PROPERTY_USAGE_DEFAULT;
     }
     else if (property_name == scale_uv_by_width_name)
     {
         p_property.usage = (profile == PROFILE_FLAT) ? PROPERTY_USAGE_DEFAULT
                                                      : PROPERTY_USAGE_NO_EDITOR;
     }
+    else if (property_name == profile_shape_name ||
+             property_name == profile_hard_corners_name ||
+             property_name == profile_closed_name)
+    {
+        p_property.usage = (profile == PROFILE_CUSTOM)
+                               ? PROPERTY_USAGE_DEFAULT
+                               : PROPERTY_USAGE_NO_EDITOR;
+    }
+    else if (property_name == refinement_delay_name ||
+             property_name == refinement_time_budget_name ||
+             property_name == preview_tessellation_tolerance_name ||
+             property_name == preview_segments_name)
+    {
+        p_property.usage = progressive_refinement ? PROPERTY_USAGE_DEFAULT
+                                                  : PROPERTY_USAGE_NO_EDITOR;
+    }
 }
 
 void CurveMesh::_bind_methods()
 {
     ClassDB::bind_method(D_METHOD("set_curve", "curve"), &CurveMesh::set_curve);
     ClassDB::bind_method(D_METHOD("get_curve"), &CurveMesh::get_curve);
+    ClassDB::bind_method(D_METHOD("set_curve_data", "data"),
+                         &CurveMesh::set_curve_data);
+    ClassDB::bind_method(D_METHOD("get_curve_data"),
+                         &CurveMesh::get_curve_data);
+    ClassDB::bind_method(D_METHOD("set_curve_data_range", "range"),
+                         &CurveMesh::set_curve_data_range);
+    ClassDB::bind_method(D_METHOD("get_curve_data_range"),
+                         &CurveMesh::get_curve_data_range);
+    ClassDB::bind_method(
+        D_METHOD("set_points", "positions", "tilts", "widths"),
+        &CurveMesh::set_points, DEFVAL(PackedFloat32Array()),
+        DEFVAL(PackedFloat32Array()));
+    ClassDB::bind_method(D_METHOD("get_points"), &CurveMesh::get_points);
+    ClassDB::bind_method(D_METHOD("clear_points"), &CurveMesh::clear_points);
+    ClassDB::bind_method(D_METHOD("is_using_points"),
+                         &CurveMesh::is_using_points);
 
     ClassDB::bind_method(D_METHOD("set_width", "width"), &CurveMesh::set_width);
     ClassDB::bind_method(D_METHOD("get_width"), &CurveMesh::get_width);
@@ -1107,6 +3368,11 @@ void CurveMesh::_bind_methods()
     ClassDB::bind_method(D_METHOD("get_tessellation_tolerance"),
                          &CurveMesh::get_tessellation_tolerance);
 
+    ClassDB::bind_method(D_METHOD("set_decimation_tolerance", "tolerance"),
+                         &CurveMesh::set_decimation_tolerance);
+    ClassDB::bind_method(D_METHOD("get_decimation_tolerance"),
+                         &CurveMesh::get_decimation_tolerance);
+
     ClassDB::bind_method(D_METHOD("set_corner_threshold", "corner_threshold"),
                          &CurveMesh::set_corner_threshold);
     ClassDB::bind_method(D_METHOD("get_corner_threshold"),
@@ -1126,6 +3392,10 @@ void CurveMesh::_bind_methods()
                          &CurveMesh::set_filter_overlaps);
     ClassDB::bind_method(D_METHOD("is_filter_overlaps"),
                          &CurveMesh::is_filter_overlaps);
+    ClassDB::bind_method(D_METHOD("set_filter_distant_overlaps", "enable"),
+                         &CurveMesh::set_filter_distant_overlaps);
+    ClassDB::bind_method(D_METHOD("is_filter_distant_overlaps"),
+                         &CurveMesh::is_filter_distant_overlaps);
 
     ClassDB::bind_method(D_METHOD("set_up_vector", "up_vector"),
                          &CurveMesh::set_up_vector);
@@ -1144,9 +3414,130 @@ void CurveMesh::_bind_methods()
                          &CurveMesh::set_segments);
     ClassDB::bind_method(D_METHOD("get_segments"), &CurveMesh::get_segments);
 
+    ClassDB::bind_method(D_METHOD("set_profile_shape", "shape"),
+                         &CurveMesh::set_profile_shape);
+    ClassDB::bind_method(D_METHOD("get_profile_shape"),
+                         &CurveMesh::get_profile_shape);
+
+    ClassDB::bind_method(D_METHOD("set_profile_hard_corners", "corners"),
+                         &CurveMesh::set_profile_hard_corners);
+    ClassDB::bind_method(D_METHOD("get_profile_hard_corners"),
+                         &CurveMesh::get_profile_hard_corners);
+
+    ClassDB::bind_method(D_METHOD("set_profile_closed", "closed"),
+                         &CurveMesh::set_profile_closed);
+    ClassDB::bind_method(D_METHOD("is_profile_closed"),
+                         &CurveMesh::is_profile_closed);
+
+    ClassDB::bind_method(D_METHOD("set_optimize_vertex_cache", "enable"),
+                         &CurveMesh::set_optimize_vertex_cache);
+    ClassDB::bind_method(D_METHOD("is_optimize_vertex_cache"),
+                         &CurveMesh::is_optimize_vertex_cache);
+
+    ClassDB::bind_method(D_METHOD("set_cull_degenerate_triangles", "enable"),
+                         &CurveMesh::set_cull_degenerate_triangles);
+    ClassDB::bind_method(D_METHOD("is_cull_degenerate_triangles"),
+                         &CurveMesh::is_cull_degenerate_triangles);
+
+    ClassDB::bind_method(
+        D_METHOD("set_degenerate_area_threshold", "threshold"),
+        &CurveMesh::set_degenerate_area_threshold);
+    ClassDB::bind_method(D_METHOD("get_degenerate_area_threshold"),
+                         &CurveMesh::get_degenerate_area_threshold);
+
+    ClassDB::bind_method(D_METHOD("set_max_vertices", "max_vertices"),
+                         &CurveMesh::set_max_vertices);
+    ClassDB::bind_method(D_METHOD("get_max_vertices"),
+                         &CurveMesh::get_max_vertices);
+
+    ClassDB::bind_method(D_METHOD("set_max_triangles", "max_triangles"),
+                         &CurveMesh::set_max_triangles);
+    ClassDB::bind_method(D_METHOD("get_max_triangles"),
+                         &CurveMesh::get_max_triangles);
+
+    ClassDB::bind_method(D_METHOD("set_skin_bone_count", "count"),
+                         &CurveMesh::set_skin_bone_count);
+    ClassDB::bind_method(D_METHOD("get_skin_bone_count"),
+                         &CurveMesh::get_skin_bone_count);
+
+    ClassDB::bind_method(D_METHOD("set_add_shader_channels", "enable"),
+                         &CurveMesh::set_add_shader_channels);
+    ClassDB::bind_method(D_METHOD("get_add_shader_channels"),
+                         &CurveMesh::get_add_shader_channels);
+
+    ClassDB::bind_method(D_METHOD("set_use_scheduler", "enable"),
+                         &CurveMesh::set_use_scheduler);
+    ClassDB::bind_method(D_METHOD("is_using_scheduler"),
+                         &CurveMesh::is_using_scheduler);
+
+    ClassDB::bind_method(D_METHOD("set_progressive_refinement", "enable"),
+                         &CurveMesh::set_progressive_refinement);
+    ClassDB::bind_method(D_METHOD("is_progressive_refinement"),
+                         &CurveMesh::is_progressive_refinement);
+
+    ClassDB::bind_method(D_METHOD("set_refinement_delay", "delay"),
+                         &CurveMesh::set_refinement_delay);
+    ClassDB::bind_method(D_METHOD("get_refinement_delay"),
+                         &CurveMesh::get_refinement_delay);
+
+    ClassDB::bind_method(D_METHOD("set_refinement_time_budget", "budget"),
+                         &CurveMesh::set_refinement_time_budget);
+    ClassDB::bind_method(D_METHOD("get_refinement_time_budget"),
+                         &CurveMesh::get_refinement_time_budget);
+
+    ClassDB::bind_method(
+        D_METHOD("set_preview_tessellation_tolerance", "tolerance"),
+        &CurveMesh::set_preview_tessellation_tolerance);
+    ClassDB::bind_method(D_METHOD("get_preview_tessellation_tolerance"),
+                         &CurveMesh::get_preview_tessellation_tolerance);
+
+    ClassDB::bind_method(D_METHOD("set_preview_segments", "segments"),
+                         &CurveMesh::set_preview_segments);
+    ClassDB::bind_method(D_METHOD("get_preview_segments"),
+                         &CurveMesh::get_preview_segments);
+
+    ClassDB::bind_method(D_METHOD("_on_curve_changed"),
+                         &CurveMesh::_on_curve_changed);
+
+    ClassDB::bind_method(D_METHOD("create_triangle_strip_mesh"),
+                         &CurveMesh::create_triangle_strip_mesh);
+
+    ClassDB::bind_method(D_METHOD("create_skeleton"),
+                         &CurveMesh::create_skeleton);
+    ClassDB::bind_method(D_METHOD("pose_skeleton", "skeleton", "curve"),
+                         &CurveMesh::pose_skeleton);
+
+    ClassDB::bind_method(D_METHOD("estimate_cost"), &CurveMesh::estimate_cost);
+
+    ClassDB::bind_method(D_METHOD("get_closest_offset", "point"),
+                         &CurveMesh::get_closest_offset);
+    ClassDB::bind_method(D_METHOD("get_distance", "point"),
+                         &CurveMesh::get_distance);
+    ClassDB::bind_method(D_METHOD("intersect_ray", "from", "direction"),
+                         &CurveMesh::intersect_ray);
+    ClassDB::bind_method(D_METHOD("get_closest_offsets", "points"),
+                         &CurveMesh::get_closest_offsets);
+    ClassDB::bind_method(D_METHOD("get_distances", "points"),
+                         &CurveMesh::get_distances);
+    ClassDB::bind_method(D_METHOD("intersect_rays", "from", "directions"),
+                         &CurveMesh::intersect_rays);
+    ClassDB::bind_method(D_METHOD("get_generated_aabb"),
+                         &CurveMesh::get_generated_aabb);
+    ClassDB::bind_method(D_METHOD("get_generation_stats"),
+                         &CurveMesh::get_generation_stats);
+
     ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve",
                               PROPERTY_HINT_RESOURCE_TYPE, "Curve3D"),
                  "set_curve", "get_curve");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve_data",
+                              PROPERTY_HINT_RESOURCE_TYPE, "CurveDataFile"),
+                 "set_curve_data", "get_curve_data");
+    ADD_PROPERTY(PropertyInfo(Variant::VECTOR2I, "curve_data_range",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:First point and point count read "
+                              "from curve_data; a count of 0 reads to the "
+                              "end."),
+                 "set_curve_data_range", "get_curve_data_range");
     ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "width", PROPERTY_HINT_RANGE,
                               "0.0,2.0,0.001,or_greater"),
                  "set_width", "get_width");
@@ -1156,11 +3547,20 @@ void CurveMesh::_bind_methods()
     ADD_PROPERTY(PropertyInfo(Variant::BOOL, "scale_uv_by_width"),
                  "set_scale_uv_by_width", "is_scale_uv_by_width");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "profile", PROPERTY_HINT_ENUM,
-                              "Flat,Cross,Tube"),
+                              "Flat,Cross,Tube,Custom"),
                  "set_profile", "get_profile");
     ADD_PROPERTY(PropertyInfo(Variant::INT, "segments", PROPERTY_HINT_RANGE,
                               "2,100,1,or_greater"),
                  "set_segments", "get_segments");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR2_ARRAY, "profile_shape"),
+                 "set_profile_shape", "get_profile_shape");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_INT32_ARRAY,
+                              "profile_hard_corners", PROPERTY_HINT_NONE,
+                              "hint_tooltip:Profile vertices with split "
+                              "normals."),
+                 "set_profile_hard_corners", "get_profile_hard_corners");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "profile_closed"),
+                 "set_profile_closed", "is_profile_closed");
     ADD_PROPERTY(PropertyInfo(Variant::BOOL, "tile_segment_uv",
                               PROPERTY_HINT_NONE,
                               "hint_tooltip:Tile UVs for each segment."),
@@ -1183,6 +3583,10 @@ void CurveMesh::_bind_methods()
                               PROPERTY_HINT_RANGE,
                               "0.001,16.0,0.001,or_greater,suffix:m"),
                  "set_tessellation_tolerance", "get_tessellation_tolerance");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "decimation_tolerance",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,1.0,0.001,or_greater,suffix:m"),
+                 "set_decimation_tolerance", "get_decimation_tolerance");
     ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "corner_threshold",
                               PROPERTY_HINT_RANGE,
                               "0.0,180.0,0.1,radians_as_degrees"),
@@ -1199,8 +3603,73 @@ void CurveMesh::_bind_methods()
     ADD_PROPERTY(
         PropertyInfo(Variant::BOOL, "filter_overlaps", PROPERTY_HINT_NONE),
         "set_filter_overlaps", "is_filter_overlaps");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "filter_distant_overlaps",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Also remove vertices buried "
+                              "where distant parts of the curve cross."),
+                 "set_filter_distant_overlaps", "is_filter_distant_overlaps");
     ADD_PROPERTY(PropertyInfo(Variant::BOOL, "scale_uv_by_length"),
                  "set_scale_uv_by_length", "is_scale_uv_by_length");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "optimize_vertex_cache",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Reorder triangles for the GPU "
+                              "vertex cache."),
+                 "set_optimize_vertex_cache", "is_optimize_vertex_cache");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "cull_degenerate_triangles",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Remove triangles with no visible "
+                              "area."),
+                 "set_cull_degenerate_triangles",
+                 "is_cull_degenerate_triangles");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "degenerate_area_threshold",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,0.01,0.000001,or_greater"),
+                 "set_degenerate_area_threshold",
+                 "get_degenerate_area_threshold");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "max_vertices", PROPERTY_HINT_RANGE,
+                              "0,65536,1,or_greater"),
+                 "set_max_vertices", "get_max_vertices");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "max_triangles",
+                              PROPERTY_HINT_RANGE, "0,65536,1,or_greater"),
+                 "set_max_triangles", "get_max_triangles");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "skin_bone_count",
+                              PROPERTY_HINT_RANGE,
+                              "0,64,1,or_greater,hint_tooltip:Bones spread "
+                              "along the curve that the vertices are "
+                              "weighted to. 0 disables skinning."),
+                 "set_skin_bone_count", "get_skin_bone_count");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "add_shader_channels",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Write arc length, radius and "
+                              "direction from the centerline to CUSTOM0 and "
+                              "CUSTOM1 for curve_mesh.gdshaderinc."),
+                 "set_add_shader_channels", "get_add_shader_channels");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_scheduler",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Rebuild through "
+                              "CurveMeshScheduler on worker threads."),
+                 "set_use_scheduler", "is_using_scheduler");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "progressive_refinement",
+                              PROPERTY_HINT_NONE,
+                              "hint_tooltip:Show a coarse preview while the "
+                              "curve is being edited."),
+                 "set_progressive_refinement", "is_progressive_refinement");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "refinement_delay",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,2.0,0.01,or_greater,suffix:s"),
+                 "set_refinement_delay", "get_refinement_delay");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "refinement_time_budget",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,100.0,0.1,or_greater,suffix:ms"),
+                 "set_refinement_time_budget", "get_refinement_time_budget");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "preview_tessellation_tolerance",
+                              PROPERTY_HINT_RANGE,
+                              "0.001,45.0,0.001,or_greater"),
+                 "set_preview_tessellation_tolerance",
+                 "get_preview_tessellation_tolerance");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "preview_segments",
+                              PROPERTY_HINT_RANGE, "2,100,1,or_greater"),
+                 "set_preview_segments", "get_preview_segments");
 
     BIND_ENUM_CONSTANT(TESSELLATION_BAKED);
     BIND_ENUM_CONSTANT(TESSELLATION_DISABLED);
@@ -1209,6 +3678,7 @@ void CurveMesh::_bind_methods()
     BIND_ENUM_CONSTANT(PROFILE_FLAT);
     BIND_ENUM_CONSTANT(PROFILE_CROSS);
     BIND_ENUM_CONSTANT(PROFILE_TUBE);
+    BIND_ENUM_CONSTANT(PROFILE_CUSTOM);
 }
 
 void CurveMesh::set_curve(const Ref<Curve3D> &p_curve)
@@ -1218,7 +3688,8 @@ void CurveMesh::set_curve(const Ref<Curve3D> &p_curve)
         return;
     }
 
-    Callable update_callable(this, "request_update");
+    _wait_for_refinement();
+    Callable update_callable(this, "_on_curve_changed");
 
     if (curve.is_valid())
     {
@@ -1226,6 +3697,10 @@ void CurveMesh::set_curve(const Ref<Curve3D> &p_curve)
     }
 
     curve = p_curve;
+    use_direct_points = false;
+    point_positions.clear();
+    point_tilts.clear();
+    point_widths.clear();
 
     if (curve.is_valid())
     {
@@ -1233,18 +3708,107 @@ void CurveMesh::set_curve(const Ref<Curve3D> &p_curve)
                        Object::CONNECT_REFERENCE_COUNTED);
     }
 
+    // curve_data takes precedence, so a new curve replaces the file too.
+    if (curve.is_valid() && curve_data.is_valid())
+    {
+        curve_data->disconnect("changed", update_callable);
+        curve_data.unref();
+        notify_property_list_changed();
+    }
+
 rest_request_update:
-    request_update();
+    _queue_update();
+}
+
+Ref<Curve3D> CurveMesh::get_curve() const { return curve; }
+
+void CurveMesh::set_curve_data(const Ref<CurveDataFile> &p_data)
+{
+    if (curve_data == p_data)
+    {
+        return;
+    }
+
+    _wait_for_refinement();
+    Callable update_callable(this, "_on_curve_changed");
+
+    if (curve_data.is_valid())
+    {
+        curve_data->disconnect("changed", update_callable);
+    }
+
+    curve_data = p_data;
+    use_direct_points = false;
+    point_positions.clear();
+    point_tilts.clear();
+    point_widths.clear();
+
+    if (curve_data.is_valid())
+    {
+        curve_data->connect("changed", update_callable,
+                            Object::CONNECT_REFERENCE_COUNTED);
+    }
+
+    notify_property_list_changed();
+    _queue_update();
+}
+
+Ref<CurveDataFile> CurveMesh::get_curve_data() const { return curve_data; }
+
+void CurveMesh::set_curve_data_range(const Vector2i &p_range)
+{
+    const Vector2i range(Math::max(p_range.x, 0), Math::max(p_range.y, 0));
+    if (curve_data_range != range)
+    {
+        curve_data_range = range;
+        _queue_update();
+    }
+}
+
+Vector2i CurveMesh::get_curve_data_range() const { return curve_data_range; }
+
+void CurveMesh::set_points(const PackedVector3Array &p_positions,
+                           const PackedFloat32Array &p_tilts,
+                           const PackedFloat32Array &p_widths)
+{
+    ERR_FAIL_COND_MSG(!p_tilts.is_empty() &&
+                          p_tilts.size() != p_positions.size(),
+                      "Tilts must be empty or match the positions in size.");
+    ERR_FAIL_COND_MSG(!p_widths.is_empty() &&
+                          p_widths.size() != p_positions.size(),
+                      "Widths must be empty or match the positions in size.");
+
+    point_positions = p_positions;
+    point_tilts = p_tilts;
+    point_widths = p_widths;
+    use_direct_points = true;
+    _queue_update();
+}
+
+PackedVector3Array CurveMesh::get_points() const { return point_positions; }
+
+void CurveMesh::clear_points()
+{
+    if (!use_direct_points)
+    {
+        return;
+    }
+
+    use_direct_points = false;
+    point_positions.clear();
+    point_tilts.clear();
+    point_widths.clear();
+    _queue_update();
 }
 
-Ref<Curve3D> CurveMesh::get_curve() const { return curve; }
+bool CurveMesh::is_using_points() const { return use_direct_points; }
 
 void CurveMesh::set_width(float p_width)
 {
     if (!Math::is_equal_approx(width, p_width))
     {
         width = p_width;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1257,7 +3821,8 @@ void CurveMesh::set_width_curve(const Ref<Curve> &p_curve)
         return;
     }
 
-    Callable update_callable(this, "request_update");
+    _wait_for_refinement();
+    Callable update_callable(this, "_on_curve_changed");
 
     if (width_curve.is_valid())
     {
@@ -1273,7 +3838,7 @@ void CurveMesh::set_width_curve(const Ref<Curve> &p_curve)
     }
 
     notify_property_list_changed();
-    request_update();
+    _queue_update();
 }
 
 Ref<Curve> CurveMesh::get_width_curve() const { return width_curve; }
@@ -1283,7 +3848,7 @@ void CurveMesh::set_scale_uv_by_length(bool p_enable)
     if (scale_uv_by_length != p_enable)
     {
         scale_uv_by_length = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1294,7 +3859,7 @@ void CurveMesh::set_scale_uv_by_width(bool p_enable)
     if (scale_uv_by_width != p_enable)
     {
         scale_uv_by_width = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1305,7 +3870,7 @@ void CurveMesh::set_tile_segment_uv(bool p_enable)
     if (tile_segment_uv != p_enable)
     {
         tile_segment_uv = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1316,7 +3881,7 @@ void CurveMesh::set_interleave_vertices(bool p_enable)
     if (interleave_vertices != p_enable)
     {
         interleave_vertices = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1327,19 +3892,34 @@ void CurveMesh::set_filter_overlaps(bool p_enable)
     if (filter_overlaps != p_enable)
     {
         filter_overlaps = p_enable;
-        request_update();
+        notify_property_list_changed();
+        _queue_update();
     }
 }
 
 bool CurveMesh::is_filter_overlaps() const { return filter_overlaps; }
 
+void CurveMesh::set_filter_distant_overlaps(bool p_enable)
+{
+    if (filter_distant_overlaps != p_enable)
+    {
+        filter_distant_overlaps = p_enable;
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_filter_distant_overlaps() const
+{
+    return filter_distant_overlaps;
+}
+
 void CurveMesh::set_tessellation_mode(TessellationMode p_mode)
 {
     if (tessellation_mode != p_mode)
     {
         tessellation_mode = p_mode;
         notify_property_list_changed();
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1354,7 +3934,7 @@ void CurveMesh::set_tessellation_tolerance(float p_tolerance)
     if (!Math::is_equal_approx(tessellation_tolerance, clamped))
     {
         tessellation_tolerance = clamped;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1363,12 +3943,27 @@ float CurveMesh::get_tessellation_tolerance() const
     return tessellation_tolerance;
 }
 
+void CurveMesh::set_decimation_tolerance(float p_tolerance)
+{
+    float clamped = Math::max(p_tolerance, 0.0f);
+    if (!Math::is_equal_approx(decimation_tolerance, clamped))
+    {
+        decimation_tolerance = clamped;
+        _queue_update();
+    }
+}
+
+float CurveMesh::get_decimation_tolerance() const
+{
+    return decimation_tolerance;
+}
+
 void CurveMesh::set_corner_threshold(float p_threshold)
 {
     if (!Math::is_equal_approx(corner_threshold, p_threshold))
     {
         corner_threshold = p_threshold;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1379,7 +3974,7 @@ void CurveMesh::set_smooth_shaded_corners(bool p_enable)
     if (smooth_shaded_corners != p_enable)
     {
         smooth_shaded_corners = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1393,7 +3988,7 @@ void CurveMesh::set_up_vector(const Vector3 &p_up_vector)
     if (!up_vector.is_equal_approx(p_up_vector))
     {
         up_vector = p_up_vector;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1404,7 +3999,7 @@ void CurveMesh::set_follow_curve(bool p_enable)
     if (follow_curve != p_enable)
     {
         follow_curve = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1424,7 +4019,7 @@ void CurveMesh::set_profile(Profile p_profile)
             segments = Math::max(segments, 3);
         }
         notify_property_list_changed();
-        request_update();
+        _queue_update();
     }
 }
 
@@ -1437,21 +4032,583 @@ void CurveMesh::set_segments(int p_segments)
     if (segments != clamped)
     {
         segments = clamped;
-        request_update();
+        _queue_update();
     }
 }
 
 int CurveMesh::get_segments() const { return segments; }
 
+void CurveMesh::set_profile_shape(const PackedVector2Array &p_shape)
+{
+    profile_shape = p_shape;
+    _update_profile_template();
+    _queue_update();
+}
+
+PackedVector2Array CurveMesh::get_profile_shape() const
+{
+    return profile_shape;
+}
+
+void CurveMesh::set_profile_hard_corners(const PackedInt32Array &p_corners)
+{
+    profile_hard_corners = p_corners;
+    _update_profile_template();
+    _queue_update();
+}
+
+PackedInt32Array CurveMesh::get_profile_hard_corners() const
+{
+    return profile_hard_corners;
+}
+
+void CurveMesh::set_profile_closed(bool p_closed)
+{
+    if (profile_closed != p_closed)
+    {
+        profile_closed = p_closed;
+        _update_profile_template();
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_profile_closed() const { return profile_closed; }
+
 void CurveMesh::set_extend_edges(bool p_enable)
 {
     if (extend_edges != p_enable)
     {
         extend_edges = p_enable;
-        request_update();
+        _queue_update();
     }
 }
 
 bool CurveMesh::is_extend_edges() const { return extend_edges; }
 
+void CurveMesh::set_optimize_vertex_cache(bool p_enable)
+{
+    if (optimize_vertex_cache != p_enable)
+    {
+        optimize_vertex_cache = p_enable;
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_optimize_vertex_cache() const
+{
+    return optimize_vertex_cache;
+}
+
+void CurveMesh::set_cull_degenerate_triangles(bool p_enable)
+{
+    if (cull_degenerate_triangles != p_enable)
+    {
+        cull_degenerate_triangles = p_enable;
+        notify_property_list_changed();
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_cull_degenerate_triangles() const
+{
+    return cull_degenerate_triangles;
+}
+
+void CurveMesh::set_degenerate_area_threshold(float p_threshold)
+{
+    float clamped = Math::max(p_threshold, 0.0f);
+    if (!Math::is_equal_approx(degenerate_area_threshold, clamped))
+    {
+        degenerate_area_threshold = clamped;
+        _queue_update();
+    }
+}
+
+float CurveMesh::get_degenerate_area_threshold() const
+{
+    return degenerate_area_threshold;
+}
+
+void CurveMesh::set_max_vertices(int p_max_vertices)
+{
+    int clamped = Math::max(p_max_vertices, 0);
+    if (max_vertices != clamped)
+    {
+        max_vertices = clamped;
+        _queue_update();
+    }
+}
+
+int CurveMesh::get_max_vertices() const { return max_vertices; }
+
+void CurveMesh::set_max_triangles(int p_max_triangles)
+{
+    int clamped = Math::max(p_max_triangles, 0);
+    if (max_triangles != clamped)
+    {
+        max_triangles = clamped;
+        _queue_update();
+    }
+}
+
+int CurveMesh::get_max_triangles() const { return max_triangles; }
+
+void CurveMesh::set_skin_bone_count(int p_count)
+{
+    int clamped = Math::max(p_count, 0);
+    if (skin_bone_count != clamped)
+    {
+        skin_bone_count = clamped;
+        _queue_update();
+    }
+}
+
+int CurveMesh::get_skin_bone_count() const { return skin_bone_count; }
+
+void CurveMesh::set_add_shader_channels(bool p_enable)
+{
+    if (add_shader_channels != p_enable)
+    {
+        add_shader_channels = p_enable;
+        _queue_update();
+    }
+}
+
+bool CurveMesh::get_add_shader_channels() const
+{
+    return add_shader_channels;
+}
+
+void CurveMesh::set_use_scheduler(bool p_enable)
+{
+    if (use_scheduler != p_enable)
+    {
+        use_scheduler = p_enable;
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_using_scheduler() const { return use_scheduler; }
+
+void CurveMesh::set_progressive_refinement(bool p_enable)
+{
+    if (progressive_refinement != p_enable)
+    {
+        progressive_refinement = p_enable;
+        notify_property_list_changed();
+        _queue_update();
+    }
+}
+
+bool CurveMesh::is_progressive_refinement() const
+{
+    return progressive_refinement;
+}
+
+void CurveMesh::set_refinement_delay(float p_delay)
+{
+    refinement_delay = Math::max(p_delay, 0.0f);
+}
+
+float CurveMesh::get_refinement_delay() const { return refinement_delay; }
+
+void CurveMesh::set_refinement_time_budget(float p_budget)
+{
+    refinement_time_budget = Math::max(p_budget, 0.0f);
+}
+
+float CurveMesh::get_refinement_time_budget() const
+{
+    return refinement_time_budget;
+}
+
+void CurveMesh::set_preview_tessellation_tolerance(float p_tolerance)
+{
+    preview_tessellation_tolerance = p_tolerance;
+}
+
+float CurveMesh::get_preview_tessellation_tolerance() const
+{
+    return preview_tessellation_tolerance;
+}
+
+void CurveMesh::set_preview_segments(int p_segments)
+{
+    preview_segments = Math::max(p_segments, 2);
+}
+
+int CurveMesh::get_preview_segments() const { return preview_segments; }
+
+void CurveMesh::_get_bone_transforms(
+    const CurveSnapshot &snapshot, GenerationSettings &settings,
+    LocalVector<Transform3D> &r_transforms) const
+{
+    r_transforms.resize(skin_bone_count);
+    for (Transform3D &transform : r_transforms)
+    {
+        transform = Transform3D();
+    }
+    if (snapshot.point_count < 2)
+    {
+        return;
+    }
+
+    // Same centerline as the build, so the bones sit at the offsets the
+    // skin weights were computed from.
+    LocalVector<CenterPoint> center_points;
+    real_t total_length = 0.0;
+    if (max_vertices > 0 || max_triangles > 0)
+    {
+        _fit_to_budget(snapshot, settings, center_points, total_length);
+    }
+    else
+    {
+        _generate_curve_points(snapshot, settings, center_points,
+                               total_length);
+    }
+    const int point_count = center_points.size();
+    if (point_count == 0)
+    {
+        return;
+    }
+
+    // Frames follow the edge vertex kernel: forward is the averaged tangent
+    // and up is turned by the point tilt.
+    LocalVector<Vector3> forwards;
+    LocalVector<Vector3> ups;
+    forwards.resize(point_count);
+    ups.resize(point_count);
+    Vector3 current_up = settings.up_vector.normalized();
+    for (int i = 0; i < point_count; i++)
+    {
+        const CenterPoint &center_point = center_points[i];
+        const Vector3 tangent_avg =
+            (center_point.tangent_next + center_point.tangent_prev)
+                .normalized();
+        Vector3 binormal;
+        if (!settings.follow_curve)
+        {
+            const Vector3 local_up =
+                settings.up_vector.slide(center_point.tangent_next)
+                    .normalized();
+            binormal = tangent_avg.cross(local_up);
+        }
+        else
+        {
+            binormal = tangent_avg.cross(current_up);
+            current_up = binormal.cross(tangent_avg);
+        }
+        binormal.normalize();
+        binormal = binormal.rotated(tangent_avg, center_point.tilt);
+        forwards[i] = tangent_avg;
+        ups[i] = binormal.cross(tangent_avg).normalized();
+    }
+
+    for (int k = 0; k < skin_bone_count; k++)
+    {
+        const float distance =
+            _get_bone_offset(k, skin_bone_count, snapshot.closed) *
+            total_length;
+
+        int prev = 0;
+        while (prev + 1 < point_count &&
+               center_points[prev + 1].partial_length <= distance)
+        {
+            prev++;
+        }
+        // On a closed curve the stretch after the last point leads back to
+        // the first one.
+        int next = prev + 1;
+        float next_length = 0.0f;
+        if (next < point_count)
+        {
+            next_length = center_points[next].partial_length;
+        }
+        else if (snapshot.closed)
+        {
+            next = 0;
+            next_length = total_length;
+        }
+        else
+        {
+            next = prev;
+            next_length = center_points[prev].partial_length;
+        }
+
+        const float segment_length =
+            next_length - center_points[prev].partial_length;
+        const float weight =
+            (segment_length > 0.0f)
+                ? Math::clamp((distance - center_points[prev].partial_length) /
+                                  segment_length,
+                              0.0f, 1.0f)
+                : 0.0f;
+
+        const Vector3 forward =
+            forwards[prev].lerp(forwards[next], weight).normalized();
+        const Vector3 up = ups[prev].lerp(ups[next], weight);
+        const Vector3 side = up.cross(forward).normalized();
+
+        Transform3D &transform = r_transforms[k];
+        transform.basis = Basis(side, forward.cross(side), forward);
+        transform.origin = center_points[prev].position.lerp(
+            center_points[next].position, weight);
+    }
+}
+
+Skeleton3D *CurveMesh::create_skeleton() const
+{
+    ERR_FAIL_COND_V_MSG(skin_bone_count <= 0, nullptr,
+                        "CurveMesh: skin_bone_count must be greater than 0.");
+
+    // The bones rest where the mesh was generated, so it is not deformed
+    // until the skeleton is posed along a new curve.
+    GenerationSettings settings = _get_generation_settings(false);
+    CurveSnapshot snapshot;
+    _take_curve_snapshot(settings.tessellation_mode, snapshot);
+    LocalVector<Transform3D> rests;
+    _get_bone_transforms(snapshot, settings, rests);
+
+    Skeleton3D *skeleton = memnew(Skeleton3D);
+    for (int k = 0; k < skin_bone_count; k++)
+    {
+        skeleton->add_bone("Bone" + String::num_int64(k));
+        skeleton->set_bone_rest(k, rests[k]);
+    }
+    skeleton->reset_bone_poses();
+    return skeleton;
+}
+
+void CurveMesh::pose_skeleton(Skeleton3D *p_skeleton,
+                              const Ref<Curve3D> &p_curve) const
+{
+    ERR_FAIL_NULL(p_skeleton);
+    ERR_FAIL_COND(p_curve.is_null());
+
+    GenerationSettings settings = _get_generation_settings(false);
+    CurveSnapshot snapshot;
+    _take_curve3d_snapshot(p_curve, settings.tessellation_mode, snapshot);
+    LocalVector<Transform3D> poses;
+    _get_bone_transforms(snapshot, settings, poses);
+
+    const int bone_count =
+        Math::min(skin_bone_count, (int)p_skeleton->get_bone_count());
+    for (int k = 0; k < bone_count; k++)
+    {
+        p_skeleton->set_bone_pose_position(k, poses[k].origin);
+        p_skeleton->set_bone_pose_rotation(
+            k, poses[k].basis.get_rotation_quaternion());
+    }
+}
+
+Dictionary CurveMesh::estimate_cost() const
+{
+    GenerationSettings settings = _get_generation_settings(false);
+    CurveSnapshot snapshot;
+    _take_curve_snapshot(settings.tessellation_mode, snapshot);
+
+    Vector2i counts;
+    bool fits_budget = true;
+    if (snapshot.point_count > 1)
+    {
+        LocalVector<CenterPoint> center_points;
+        real_t total_length = 0.0;
+        if (max_vertices > 0 || max_triangles > 0)
+        {
+            fits_budget = _fit_to_budget(snapshot, settings, center_points,
+                                         total_length);
+        }
+        else
+        {
+            _generate_curve_points(snapshot, settings, center_points,
+                                   total_length);
+        }
+        counts = _estimate_counts(center_points, snapshot.closed,
+                                  _get_radial_segments(settings), settings);
+    }
+
+    Dictionary cost;
+    cost["vertex_count"] = counts.x;
+    cost["triangle_count"] = counts.y;
+    cost["index_count"] = counts.y * 3;
+    cost["fits_budget"] = fits_budget;
+    return cost;
+}
+
+void CurveMesh::_update_query_tree() const
+{
+    if (query_tree_valid && query_tree_serial == build_serial)
+    {
+        return;
+    }
+    query_tree_valid = true;
+    query_tree_serial = build_serial;
+    query_tree.clear();
+
+    GenerationSettings settings = _get_generation_settings(false);
+    CurveSnapshot snapshot;
+    _take_curve_snapshot(settings.tessellation_mode, snapshot);
+    if (snapshot.point_count <= 1)
+    {
+        return;
+    }
+
+    LocalVector<CenterPoint> center_points;
+    real_t total_length = 0.0;
+    if (max_vertices > 0 || max_triangles > 0)
+    {
+        _fit_to_budget(snapshot, settings, center_points, total_length);
+    }
+    else
+    {
+        _generate_curve_points(snapshot, settings, center_points,
+                               total_length);
+    }
+
+    const int point_count = center_points.size();
+    if (point_count < 2)
+    {
+        return;
+    }
+
+    // Same width as the edge vertices, out to the farthest profile vertex.
+    const float profile_extent = get_profile_extent();
+    LocalVector<float> radii;
+    radii.resize(point_count);
+    for (int i = 0; i < point_count; i++)
+    {
+        float local_width = center_points[i].width;
+        if (settings.width_curve.is_valid() && total_length > 0.0f)
+        {
+            local_width *= settings.width_curve->sample(
+                center_points[i].partial_length / total_length);
+        }
+        radii[i] = width * local_width * profile_extent;
+    }
+
+    for (int i = 0; i < point_count - 1; i++)
+    {
+        query_tree.add_segment(center_points[i].position,
+                               center_points[i + 1].position, radii[i],
+                               radii[i + 1], center_points[i].partial_length,
+                               center_points[i + 1].partial_length);
+    }
+    if (snapshot.closed)
+    {
+        query_tree.add_segment(center_points[point_count - 1].position,
+                               center_points[0].position,
+                               radii[point_count - 1], radii[0],
+                               center_points[point_count - 1].partial_length,
+                               total_length);
+    }
+    query_tree.build();
+}
+
+float CurveMesh::get_closest_offset(const Vector3 &p_point) const
+{
+    _update_query_tree();
+    float offset = 0.0f;
+    query_tree.get_closest(p_point, offset);
+    return offset;
+}
+
+float CurveMesh::get_distance(const Vector3 &p_point) const
+{
+    _update_query_tree();
+    float offset = 0.0f;
+    return query_tree.get_closest(p_point, offset);
+}
+
+Dictionary CurveMesh::intersect_ray(const Vector3 &p_from,
+                                    const Vector3 &p_direction) const
+{
+    _update_query_tree();
+    Dictionary result;
+    CurveSegmentBVH::RayHit hit;
+    const Vector3 direction = p_direction.normalized();
+    if (!query_tree.intersect_ray(p_from, direction, Math_INF, hit))
+    {
+        return result;
+    }
+
+    result["position"] = p_from + direction * hit.distance;
+    result["normal"] = hit.normal;
+    result["distance"] = hit.distance;
+    result["offset"] = hit.offset;
+    return result;
+}
+
+PackedFloat32Array
+CurveMesh::get_closest_offsets(const PackedVector3Array &p_points) const
+{
+    _update_query_tree();
+    PackedFloat32Array offsets;
+    offsets.resize(p_points.size());
+    const Vector3 *points = p_points.ptr();
+    float *offsets_w = offsets.ptrw();
+    for (int64_t i = 0; i < p_points.size(); i++)
+    {
+        query_tree.get_closest(points[i], offsets_w[i]);
+    }
+    return offsets;
+}
+
+PackedFloat32Array
+CurveMesh::get_distances(const PackedVector3Array &p_points) const
+{
+    _update_query_tree();
+    PackedFloat32Array distances;
+    distances.resize(p_points.size());
+    const Vector3 *points = p_points.ptr();
+    float *distances_w = distances.ptrw();
+    float offset = 0.0f;
+    for (int64_t i = 0; i < p_points.size(); i++)
+    {
+        distances_w[i] = query_tree.get_closest(points[i], offset);
+    }
+    return distances;
+}
+
+PackedFloat32Array
+CurveMesh::intersect_rays(const PackedVector3Array &p_from,
+                          const PackedVector3Array &p_directions) const
+{
+    ERR_FAIL_COND_V_MSG(p_from.size() != p_directions.size(),
+                        PackedFloat32Array(),
+                        "Origins and directions must have the same size.");
+    _update_query_tree();
+    PackedFloat32Array distances;
+    distances.resize(p_from.size());
+    const Vector3 *from = p_from.ptr();
+    const Vector3 *directions = p_directions.ptr();
+    float *distances_w = distances.ptrw();
+    for (int64_t i = 0; i < p_from.size(); i++)
+    {
+        CurveSegmentBVH::RayHit hit;
+        const Vector3 direction = directions[i].normalized();
+        distances_w[i] = -1.0f;
+        if (query_tree.intersect_ray(from[i], direction, Math_INF, hit))
+        {
+            distances_w[i] = hit.distance;
+        }
+    }
+    return distances;
+}
+
+AABB CurveMesh::get_generated_aabb() const { return generated_aabb; }
+
+Dictionary CurveMesh::get_generation_stats() const
+{
+    Dictionary stats;
+    stats["vertex_count"] = generation_stats.vertex_count;
+    stats["triangle_count"] = generation_stats.triangle_count;
+    stats["acmr_before"] = generation_stats.acmr_before;
+    stats["acmr_after"] = generation_stats.acmr_after;
+    stats["culled_triangle_count"] = generation_stats.culled_triangle_count;
+    stats["decimation_ratio"] = generation_stats.decimation_ratio;
+    stats["budget_exceeded"] = generation_stats.budget_exceeded;
+    stats["preview"] = generation_stats.preview;
+    return stats;
+}
+
 } // namespace godot
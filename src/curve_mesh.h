@@ -1,17 +1,26 @@
 #ifndef CURVE_MESH_H
 #define CURVE_MESH_H
 
+#include "curve_data_file.h"
+#include "curve_segment_bvh.h"
+
+#include <godot_cpp/classes/array_mesh.hpp>
 #include <godot_cpp/classes/curve.hpp>
 #include <godot_cpp/classes/curve3d.hpp>
 #include <godot_cpp/classes/primitive_mesh.hpp>
+#include <godot_cpp/classes/skeleton3d.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/property_info.hpp>
 #include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/templates/vector.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
 #include <godot_cpp/variant/packed_float32_array.hpp>
 #include <godot_cpp/variant/packed_int32_array.hpp>
 #include <godot_cpp/variant/packed_vector2_array.hpp>
 #include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
 #include <godot_cpp/variant/vector2.hpp>
 #include <godot_cpp/variant/vector2i.hpp>
 #include <godot_cpp/variant/vector3.hpp>
@@ -36,8 +45,143 @@ class CurveMesh : public PrimitiveMesh
         PROFILE_FLAT,
         PROFILE_CROSS,
         PROFILE_TUBE,
+        PROFILE_CUSTOM,
+    };
+
+    // Copy of the curve data taken once per rebuild, so the generation stages
+    // never call back into the Curve3D resource.
+    struct CurveSnapshot
+    {
+        LocalVector<Vector3> positions;
+        LocalVector<Vector3> in_handles;
+        LocalVector<Vector3> out_handles;
+        LocalVector<float> tilts;
+        PackedVector3Array baked_points;
+        PackedFloat32Array baked_tilts;
+        // Arrays passed to set_points(), shared rather than copied.
+        PackedVector3Array point_positions;
+        PackedFloat32Array point_tilts;
+        PackedFloat32Array point_widths;
+        int point_count = 0;
+        bool closed = false;
+        // Set when the first or last point only orients the neighbouring
+        // end ring and gets no ring of its own. Spans of a longer curve
+        // carry their neighbours this way, so the rings at a shared point
+        // come out the same in both spans.
+        bool lead_context = false;
+        bool trail_context = false;
+    };
+
+    // Custom cross-section preprocessed into the per-ring vertex pattern.
+    // connect_next is false where a vertex is not joined to the following
+    // one: at the end of the profile and between the two copies of a hard
+    // corner.
+    struct ProfileTemplate
+    {
+        LocalVector<Vector2> positions;
+        LocalVector<Vector2> normals;
+        LocalVector<float> v;
+        LocalVector<uint8_t> connect_next;
+        float length = 0.0f;
+    };
+
+    // Every input of one build, resolved on the main thread. Preview builds
+    // and builds running on a worker thread read these instead of the
+    // members, which the setters may change at any time.
+    struct GenerationSettings
+    {
+        float width = 0.5f;
+        Ref<Curve> width_curve;
+        bool extend_edges = false;
+        TessellationMode tessellation_mode = TESSELLATION_BAKED;
+        float tessellation_tolerance = 4.0f;
+        float decimation_tolerance = 0.0f;
+        Vector3 up_vector = Vector3(0.0f, 1.0f, 0.0f);
+        bool follow_curve = true;
+        float corner_threshold = 0.5236f;
+        bool smooth_shaded_corners = true;
+        Profile profile = PROFILE_FLAT;
+        int segments = 2;
+        bool profile_closed = true;
+        ProfileTemplate profile_template;
+        // Farthest reach of the profile from the centerline, per unit of
+        // width.
+        float profile_extent = 0.5f;
+        bool interleave_vertices = false;
+        bool filter_overlaps = false;
+        bool filter_distant_overlaps = false;
+        bool optimize_vertex_cache = false;
+        bool cull_degenerate_triangles = false;
+        float degenerate_area_threshold = 0.0f;
+        bool scale_uv_by_length = false;
+        bool scale_uv_by_width = false;
+        bool tile_segment_uv = true;
+        int max_vertices = 0;
+        int max_triangles = 0;
+        int skin_bone_count = 0;
+        bool add_shader_channels = false;
+        bool add_uv2 = false;
+        float uv2_padding = 0.0f;
+        // Set when the build covers only part of a curve span_length long,
+        // from span_begin to span_end as shares of that length. UVs and
+        // width_curve then follow the whole curve, and the frame is anchored
+        // at both ends so neighbouring spans line up.
+        float span_begin = 0.0f;
+        float span_end = 1.0f;
+        float span_length = 0.0f;
+    };
+
+    struct GenerationStats
+    {
+        int vertex_count = 0;
+        int triangle_count = 0;
+        float acmr_before = 0.0f;
+        float acmr_after = 0.0f;
+        float decimation_ratio = 0.0f;
+        int culled_triangle_count = 0;
+        bool budget_exceeded = false;
+        bool preview = false;
+    };
+
+    // Inputs and outputs of a build that runs on a worker thread.
+    struct BackgroundBuild
+    {
+        CurveSnapshot snapshot;
+        GenerationSettings settings;
+        Array arrays;
+        GenerationStats stats;
+        AABB aabb;
+        // Vertices of the first and last ring, in profile order, for
+        // callers that join the ends to other geometry.
+        PackedInt32Array end_rings[2];
+        uint64_t usec = 0;
+        uint32_t serial = 0;
     };
 
+    // Build API for classes that generate CurveMeshes outside of
+    // _create_mesh_array(), such as CurveMeshScheduler. prepare_build()
+    // captures the settings and a snapshot of the curve on the main thread,
+    // run_build() generates the arrays on any thread, and commit_build()
+    // makes them the surface of this mesh. Callers that bring their own
+    // points fill the snapshot and take get_build_settings() instead.
+    void prepare_build(BackgroundBuild &r_build) const;
+    GenerationSettings get_build_settings() const;
+    void run_build(BackgroundBuild &r_build) const;
+    bool commit_build(BackgroundBuild &r_build);
+
+    // Sizes for callers that lay out the generated geometry themselves.
+    // get_profile_extent() is the farthest profile vertex from the
+    // centerline per unit of width, and get_lightmap_size() is the UV2
+    // size in texels of a span of the given length.
+    float get_profile_extent() const;
+    Vector2i get_lightmap_size(float p_length, bool p_closed) const;
+    static float get_lightmap_texel_size();
+
+    // Center positions of the control points in snapshot, tessellated the
+    // way TESSELLATION_ADAPTIVE does with the given tolerance in degrees.
+    PackedVector3Array tessellate_snapshot(const CurveSnapshot &snapshot,
+                                           float p_tolerance) const;
+
   private:
     struct CenterPoint
     {
@@ -46,6 +190,7 @@ class CurveMesh : public PrimitiveMesh
         Vector3 tangent_prev;
         float partial_length = 0.0f;
         float tilt = 0.0f;
+        float width = 1.0f;
         bool corner_point = false;
     };
 
@@ -56,6 +201,8 @@ class CurveMesh : public PrimitiveMesh
         Vector2 uv;
         Vector2 uv2;
         Vector3 tangent;
+        Vector3 center;
+        float offset = 0.0f;
         int source_index = -1;
         int next_point = -1;
         int prev_point = -1;
@@ -66,14 +213,60 @@ class CurveMesh : public PrimitiveMesh
         bool prev_connected = true;
     };
 
+    // Surviving edge point in the dense per-column layout used for
+    // triangulation.
+    struct ColumnPoint
+    {
+        int vertex = -1;
+        int ring = 0;
+        int edge = 0;
+        bool prev_connected = true;
+        bool next_connected = true;
+    };
+
+    struct CompactColumns
+    {
+        LocalVector<int> offsets;
+        LocalVector<ColumnPoint> points;
+        LocalVector<uint8_t> connected;
+    };
+
+    // Attribute arrays of the generated surface. Arrays of disabled channels
+    // stay empty.
+    struct VertexArrays
+    {
+        PackedVector3Array points;
+        PackedVector3Array normals;
+        PackedFloat32Array tangents;
+        PackedVector2Array uvs;
+        PackedVector2Array uv2s;
+        PackedInt32Array bones;
+        PackedFloat32Array weights;
+        PackedByteArray custom0;
+        PackedByteArray custom1;
+    };
+
   private:
     Ref<Curve3D> curve;
+
+    // Points streamed from a curve data file. They replace the curve, and
+    // set_points() replaces them.
+    Ref<CurveDataFile> curve_data;
+    Vector2i curve_data_range;
+
+    // Center points passed to set_points(). They replace the curve and are
+    // used as is, like TESSELLATION_DISABLED.
+    PackedVector3Array point_positions;
+    PackedFloat32Array point_tilts;
+    PackedFloat32Array point_widths;
+    bool use_direct_points = false;
     float width = 0.5f;
     Ref<Curve> width_curve;
     bool extend_edges = false;
 
     TessellationMode tessellation_mode = TESSELLATION_BAKED;
     float tessellation_tolerance = 4.0f;
+    float decimation_tolerance = 0.0f;
 
     Vector3 up_vector = Vector3(0.0f, 1.0f, 0.0f);
     bool follow_curve = true;
@@ -83,33 +276,162 @@ class CurveMesh : public PrimitiveMesh
     Profile profile = PROFILE_FLAT;
     int segments = 2;
 
+    PackedVector2Array profile_shape;
+    PackedInt32Array profile_hard_corners;
+    bool profile_closed = true;
+    ProfileTemplate profile_template;
+
     bool interleave_vertices = false;
     bool filter_overlaps = false;
+    bool filter_distant_overlaps = false;
 
     bool scale_uv_by_length = false;
     bool scale_uv_by_width = false;
     bool tile_segment_uv = true;
 
+    bool optimize_vertex_cache = false;
+    bool cull_degenerate_triangles = false;
+    float degenerate_area_threshold = 0.000001f;
+
+    int max_vertices = 0;
+    int max_triangles = 0;
+
+    int skin_bone_count = 0;
+    bool add_shader_channels = false;
+
+    bool progressive_refinement = false;
+    float refinement_delay = 0.25f;
+    float refinement_time_budget = 8.0f;
+    float preview_tessellation_tolerance = 16.0f;
+    int preview_segments = 3;
+
+    mutable AABB generated_aabb;
+    mutable GenerationStats generation_stats;
+
+    bool use_scheduler = false;
+
+    // Every queued update bumps build_serial, so background builds started
+    // before it can tell they are outdated. A committed background build
+    // waits in finished_build for the next _create_mesh_array() call.
+    mutable uint32_t build_serial = 0;
+    mutable uint64_t last_build_usec = 0;
+    mutable BackgroundBuild finished_build;
+    mutable bool finished_build_ready = false;
+
+    // Progressive refinement state. refinement_build belongs to the worker
+    // while refinement_task is running.
+    mutable bool preview_requested = false;
+    uint64_t last_change_msec = 0;
+    bool refinement_timer_pending = false;
+    int64_t refinement_task = -1;
+    BackgroundBuild refinement_build;
+
+    // Built on the first query after a change, from the same center points
+    // as the mesh.
+    mutable CurveSegmentBVH query_tree;
+    mutable uint32_t query_tree_serial = 0;
+    mutable bool query_tree_valid = false;
+
   private:
     void _update_lightmap_size();
-    void _generate_curve_points(LocalVector<CenterPoint> &center_points,
+    void _update_profile_template();
+    int _get_edge_count(Profile profile) const;
+    GenerationSettings _get_generation_settings(bool p_preview) const;
+    void _take_curve_snapshot(TessellationMode p_mode,
+                              CurveSnapshot &r_snapshot) const;
+    static void _take_curve3d_snapshot(const Ref<Curve3D> &curve,
+                                       TessellationMode p_mode,
+                                       CurveSnapshot &r_snapshot);
+    void _tessellate_snapshot(const CurveSnapshot &snapshot,
+                              LocalVector<CenterPoint> &center_points,
+                              int max_stages, float tolerance) const;
+    void _generate_curve_points(const CurveSnapshot &snapshot,
+                                const GenerationSettings &settings,
+                                LocalVector<CenterPoint> &center_points,
                                 real_t &total_length) const;
+    void _update_query_tree() const;
+    void _read_direct_points(const CurveSnapshot &snapshot,
+                             LocalVector<CenterPoint> &center_points) const;
+    void _anchor_span_frame(LocalVector<CenterPoint> &center_points,
+                            real_t total_length,
+                            const GenerationSettings &settings) const;
+    void _decimate_curve_points(LocalVector<CenterPoint> &center_points,
+                                const GenerationSettings &settings,
+                                bool closed) const;
     void _generate_edge_vertices(LocalVector<CenterPoint> &center_points,
                                  real_t total_length, int radial_segments,
-                                 float uv2_padding,
+                                 const GenerationSettings &settings,
+                                 bool closed,
                                  LocalVector<EdgePoint> &edge_points) const;
+    typedef void (CurveMesh::*EdgeVertexKernel)(
+        LocalVector<CenterPoint> &center_points, real_t total_length,
+        int radial_segments, const GenerationSettings &settings, bool closed,
+        LocalVector<EdgePoint> &edge_points) const;
+    template <Profile PROFILE, int RING_SIZE, bool ZERO_WIDTH, bool ADD_UV2>
+    void _generate_edge_vertices_kernel(
+        LocalVector<CenterPoint> &center_points, real_t total_length,
+        int radial_segments, const GenerationSettings &settings, bool closed,
+        LocalVector<EdgePoint> &edge_points) const;
+    template <bool ZERO_WIDTH, bool ADD_UV2>
+    EdgeVertexKernel _get_edge_vertex_kernel(Profile profile,
+                                             int radial_segments) const;
     void _interleave_edge_vertices(LocalVector<EdgePoint> &edge_points,
                                    LocalVector<CenterPoint> &center_points,
                                    int radial_segments) const;
     void _filter_overlapping_vertices(LocalVector<EdgePoint> &edge_points,
                                       LocalVector<CenterPoint> &center_points,
-                                      int radial_segments) const;
-    void _generate_triangles(LocalVector<EdgePoint> &edge_points,
-                             int radial_segments, PackedVector3Array &points,
-                             PackedVector3Array &normals,
-                             PackedFloat32Array &tangents,
-                             PackedVector2Array &uvs, PackedVector2Array &uv2s,
+                                      int radial_segments,
+                                      const GenerationSettings &settings,
+                                      bool closed) const;
+    void _mark_distant_overlaps(LocalVector<EdgePoint> &edge_points,
+                                const LocalVector<CenterPoint> &center_points,
+                                real_t total_length, int radial_segments,
+                                const GenerationSettings &settings,
+                                bool closed) const;
+    void _generate_vertices(LocalVector<EdgePoint> &edge_points,
+                            const GenerationSettings &settings, bool closed,
+                            VertexArrays &arrays, AABB &aabb) const;
+    int _cull_degenerate_triangles(PackedInt32Array &indices,
+                                   float area_threshold, VertexArrays &arrays,
+                                   AABB &aabb) const;
+    void _compact_edge_points(const LocalVector<EdgePoint> &edge_points,
+                              int radial_segments, int edge_count,
+                              CompactColumns &columns) const;
+    void _generate_triangles(const CompactColumns &columns,
+                             int radial_segments, int edge_count,
                              PackedInt32Array &indices) const;
+    bool _stamp_ring_triangles(const CompactColumns &columns,
+                               int radial_segments, int ring_count,
+                               PackedInt32Array &indices) const;
+    bool _generate_triangle_strip(const LocalVector<EdgePoint> &edge_points,
+                                  int radial_segments, int edge_count,
+                                  PackedInt32Array &indices) const;
+    int _get_radial_segments(const GenerationSettings &settings) const;
+    void _get_bone_transforms(const CurveSnapshot &snapshot,
+                              GenerationSettings &settings,
+                              LocalVector<Transform3D> &r_transforms) const;
+    Vector2i _estimate_counts(const LocalVector<CenterPoint> &center_points,
+                              bool closed, int radial_segments,
+                              const GenerationSettings &settings) const;
+    bool _fit_to_budget(const CurveSnapshot &snapshot,
+                        GenerationSettings &settings,
+                        LocalVector<CenterPoint> &center_points,
+                        real_t &total_length) const;
+    Array _generate_mesh_arrays(const CurveSnapshot &snapshot,
+                                const GenerationSettings &p_settings,
+                                bool p_triangle_strip, bool &r_triangle_strip,
+                                GenerationStats &r_stats, AABB &r_aabb,
+                                PackedInt32Array *r_end_rings = nullptr) const;
+
+    void _queue_update();
+    void _on_curve_changed();
+    void _schedule_refinement(double p_delay);
+    void _on_refinement_timeout();
+    void _start_refinement();
+    void _run_refinement();
+    void _on_refinement_finished(uint32_t p_serial);
+    void _wait_for_refinement();
+
 
   protected:
     static void _bind_methods();
@@ -120,6 +442,19 @@ class CurveMesh : public PrimitiveMesh
     void set_curve(const Ref<Curve3D> &p_curve);
     Ref<Curve3D> get_curve() const;
 
+    void set_curve_data(const Ref<CurveDataFile> &p_data);
+    Ref<CurveDataFile> get_curve_data() const;
+
+    void set_curve_data_range(const Vector2i &p_range);
+    Vector2i get_curve_data_range() const;
+
+    void set_points(const PackedVector3Array &p_positions,
+                    const PackedFloat32Array &p_tilts = PackedFloat32Array(),
+                    const PackedFloat32Array &p_widths = PackedFloat32Array());
+    PackedVector3Array get_points() const;
+    void clear_points();
+    bool is_using_points() const;
+
     void set_width(float p_width);
     float get_width() const;
 
@@ -141,12 +476,18 @@ class CurveMesh : public PrimitiveMesh
     void set_filter_overlaps(bool p_enable);
     bool is_filter_overlaps() const;
 
+    void set_filter_distant_overlaps(bool p_enable);
+    bool is_filter_distant_overlaps() const;
+
     void set_tessellation_mode(TessellationMode p_mode);
     TessellationMode get_tessellation_mode() const;
 
     void set_tessellation_tolerance(float p_tolerance);
     float get_tessellation_tolerance() const;
 
+    void set_decimation_tolerance(float p_tolerance);
+    float get_decimation_tolerance() const;
+
     void set_corner_threshold(float p_threshold);
     float get_corner_threshold() const;
 
@@ -165,15 +506,86 @@ class CurveMesh : public PrimitiveMesh
     void set_segments(int p_segments);
     int get_segments() const;
 
+    void set_profile_shape(const PackedVector2Array &p_shape);
+    PackedVector2Array get_profile_shape() const;
+
+    void set_profile_hard_corners(const PackedInt32Array &p_corners);
+    PackedInt32Array get_profile_hard_corners() const;
+
+    void set_profile_closed(bool p_closed);
+    bool is_profile_closed() const;
+
     void set_extend_edges(bool p_enable);
     bool is_extend_edges() const;
 
+    void set_optimize_vertex_cache(bool p_enable);
+    bool is_optimize_vertex_cache() const;
+
+    void set_cull_degenerate_triangles(bool p_enable);
+    bool is_cull_degenerate_triangles() const;
+
+    void set_degenerate_area_threshold(float p_threshold);
+    float get_degenerate_area_threshold() const;
+
+    void set_max_vertices(int p_max_vertices);
+    int get_max_vertices() const;
+
+    void set_max_triangles(int p_max_triangles);
+    int get_max_triangles() const;
+
+    void set_skin_bone_count(int p_count);
+    int get_skin_bone_count() const;
+
+    void set_add_shader_channels(bool p_enable);
+    bool get_add_shader_channels() const;
+
+    void set_use_scheduler(bool p_enable);
+    bool is_using_scheduler() const;
+
+    void set_progressive_refinement(bool p_enable);
+    bool is_progressive_refinement() const;
+
+    void set_refinement_delay(float p_delay);
+    float get_refinement_delay() const;
+
+    void set_refinement_time_budget(float p_budget);
+    float get_refinement_time_budget() const;
+
+    void set_preview_tessellation_tolerance(float p_tolerance);
+    float get_preview_tessellation_tolerance() const;
+
+    void set_preview_segments(int p_segments);
+    int get_preview_segments() const;
+
+    Ref<ArrayMesh> create_triangle_strip_mesh() const;
+
+    Skeleton3D *create_skeleton() const;
+    void pose_skeleton(Skeleton3D *p_skeleton,
+                       const Ref<Curve3D> &p_curve) const;
+
+    Dictionary estimate_cost() const;
+
+    float get_closest_offset(const Vector3 &p_point) const;
+    float get_distance(const Vector3 &p_point) const;
+    Dictionary intersect_ray(const Vector3 &p_from,
+                             const Vector3 &p_direction) const;
+    PackedFloat32Array
+    get_closest_offsets(const PackedVector3Array &p_points) const;
+    PackedFloat32Array get_distances(const PackedVector3Array &p_points) const;
+    PackedFloat32Array
+    intersect_rays(const PackedVector3Array &p_from,
+                   const PackedVector3Array &p_directions) const;
+
+    AABB get_generated_aabb() const;
+    Dictionary get_generation_stats() const;
+
     static constexpr const char *get_class_icon_path()
     {
         return "res://addons/curve_mesh/icons/CurveMesh.svg";
     }
 
     CurveMesh();
+    ~CurveMesh();
 };
 
 } // namespace godot
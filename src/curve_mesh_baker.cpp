@@ -0,0 +1,403 @@
+#include "curve_mesh_baker.h"
+
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/material.hpp>
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/resource_loader.hpp>
+#include <godot_cpp/classes/resource_saver.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/packed_string_array.hpp>
+
+namespace godot
+{
+
+namespace
+{
+// Stored in the output directory, next to the baked meshes.
+const char *MANIFEST_NAME = "curve_mesh_bake.json";
+
+// Manifest entries of inputs that are neither a Curve3D nor a CurveMesh
+// start with this, so they are not loaded again while unchanged.
+const char *IGNORED_PREFIX = "ignored:";
+
+// Part of every fingerprint. Bump it whenever CurveMesh generates
+// different geometry for the same input, so existing bakes are redone.
+constexpr int GENERATOR_VERSION = 1;
+
+// Defaults of the scene importer's LOD options, in degrees.
+constexpr double LOD_NORMAL_MERGE_ANGLE = 60.0;
+constexpr double LOD_NORMAL_SPLIT_ANGLE = 25.0;
+
+static String _normalize_dir(const String &p_dir)
+{
+    const String dir = p_dir.simplify_path();
+    return dir.ends_with("://") ? dir : dir.trim_suffix("/");
+}
+
+static void _collect_inputs(const String &p_dir, const String &p_prefix,
+                            const String &p_exclude_dir,
+                            PackedStringArray &r_inputs)
+{
+    const PackedStringArray files = DirAccess::get_files_at(p_dir);
+    for (int64_t i = 0; i < files.size(); i++)
+    {
+        const String extension = files[i].get_extension().to_lower();
+        if (extension == "tres" || extension == "res")
+        {
+            r_inputs.push_back(p_prefix + files[i]);
+        }
+    }
+
+    const PackedStringArray directories = DirAccess::get_directories_at(p_dir);
+    for (int64_t i = 0; i < directories.size(); i++)
+    {
+        // Earlier outputs are resources too, and would be baked again.
+        const String dir = p_dir.path_join(directories[i]);
+        if (_normalize_dir(dir) == p_exclude_dir)
+        {
+            continue;
+        }
+        _collect_inputs(dir, p_prefix + directories[i] + "/", p_exclude_dir,
+                        r_inputs);
+    }
+}
+
+static Dictionary _load_manifest(const String &p_path)
+{
+    if (!FileAccess::file_exists(p_path))
+    {
+        return Dictionary();
+    }
+
+    const Variant manifest =
+        JSON::parse_string(FileAccess::get_file_as_string(p_path));
+    if (manifest.get_type() != Variant::DICTIONARY)
+    {
+        WARN_PRINT("CurveMeshBaker: ignoring unreadable manifest '" + p_path +
+                   "'.");
+        return Dictionary();
+    }
+    return manifest;
+}
+
+static void _save_manifest(const String &p_path, const Dictionary &p_manifest)
+{
+    Ref<FileAccess> file = FileAccess::open(p_path, FileAccess::WRITE);
+    ERR_FAIL_COND_MSG(file.is_null(), "CurveMeshBaker: cannot write '" +
+                                          p_path + "'.");
+    file->store_string(JSON::stringify(p_manifest, "\t"));
+}
+} // namespace
+
+String CurveMeshBaker::_get_fingerprint(const String &p_path) const
+{
+    // External resources, such as a Curve3D saved in its own file, are part
+    // of the input as much as the file itself.
+    String fingerprint = String::num_int64(GENERATOR_VERSION) + ":";
+    fingerprint += FileAccess::get_md5(p_path);
+    const PackedStringArray dependencies =
+        ResourceLoader::get_singleton()->get_dependencies(p_path);
+    for (int64_t i = 0; i < dependencies.size(); i++)
+    {
+        // Entries look like "uid://...::Type::res://path".
+        const String &dependency = dependencies[i];
+        const String path = dependency.get_slice(
+            "::", dependency.get_slice_count("::") - 1);
+        fingerprint += FileAccess::get_md5(path);
+    }
+    fingerprint += generate_lods ? "L" : "-";
+    fingerprint += compress_attributes ? "C" : "-";
+    return fingerprint.md5_text();
+}
+
+uint64_t CurveMeshBaker::_get_surface_flags() const
+{
+    return compress_attributes ? Mesh::ARRAY_FLAG_COMPRESS_ATTRIBUTES : 0;
+}
+
+Error CurveMeshBaker::_load_mesh(const String &p_path,
+                                 Ref<CurveMesh> &r_mesh) const
+{
+    const Ref<Resource> resource =
+        ResourceLoader::get_singleton()->load(p_path);
+    if (resource.is_null())
+    {
+        return ERR_FILE_CANT_OPEN;
+    }
+
+    r_mesh = resource;
+    if (r_mesh.is_valid())
+    {
+        return OK;
+    }
+
+    const Ref<Curve3D> curve = resource;
+    if (curve.is_null())
+    {
+        return ERR_FILE_UNRECOGNIZED;
+    }
+    r_mesh.instantiate();
+    r_mesh->set_curve(curve);
+    return OK;
+}
+
+void CurveMeshBaker::_bake_at(uint32_t p_index)
+{
+    Job &job = jobs[p_index];
+    job.mesh->run_build(job.build);
+    if (!generate_lods)
+    {
+        return;
+    }
+
+    const PackedInt32Array indices = job.build.arrays[Mesh::ARRAY_INDEX];
+    if (indices.size() < 3)
+    {
+        return;
+    }
+
+    // LOD simplification is the most expensive part of a bake, so it runs
+    // here on the worker rather than when the mesh is saved.
+    job.lod_mesh.instantiate();
+    job.lod_mesh->add_surface(Mesh::PRIMITIVE_TRIANGLES, job.build.arrays,
+                              TypedArray<Array>(), Dictionary(),
+                              Ref<Material>(), String(), _get_surface_flags());
+    job.lod_mesh->generate_lods(LOD_NORMAL_MERGE_ANGLE,
+                                LOD_NORMAL_SPLIT_ANGLE, Array());
+}
+
+bool CurveMeshBaker::_save_job(Job &r_job) const
+{
+    const PackedInt32Array indices = r_job.build.arrays[Mesh::ARRAY_INDEX];
+    if (indices.size() < 3)
+    {
+        WARN_PRINT("CurveMeshBaker: '" + r_job.input_path +
+                   "' generated no triangles.");
+        return false;
+    }
+
+    const Ref<Material> material = r_job.mesh->get_material();
+    Ref<ArrayMesh> mesh;
+    if (r_job.lod_mesh.is_valid())
+    {
+        r_job.lod_mesh->set_surface_material(0, material);
+        mesh = r_job.lod_mesh->get_mesh();
+    }
+    else
+    {
+        mesh.instantiate();
+        mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES,
+                                      r_job.build.arrays, TypedArray<Array>(),
+                                      Dictionary(), _get_surface_flags());
+        mesh->surface_set_material(0, material);
+    }
+
+    DirAccess::make_dir_recursive_absolute(r_job.output_path.get_base_dir());
+    const Error err =
+        ResourceSaver::get_singleton()->save(mesh, r_job.output_path);
+    ERR_FAIL_COND_V_MSG(err != OK, false,
+                        "CurveMeshBaker: cannot save '" + r_job.output_path +
+                            "'.");
+    return true;
+}
+
+Dictionary CurveMeshBaker::bake_directory(const String &p_input_dir,
+                                          const String &p_output_dir)
+{
+    Dictionary result;
+    result["baked"] = 0;
+    result["skipped"] = 0;
+    result["ignored"] = 0;
+    result["failed"] = 0;
+
+    ERR_FAIL_COND_V_MSG(!DirAccess::dir_exists_absolute(p_input_dir), result,
+                        "CurveMeshBaker: '" + p_input_dir +
+                            "' is not a directory.");
+    const String output_dir = _normalize_dir(p_output_dir);
+    ERR_FAIL_COND_V_MSG(_normalize_dir(p_input_dir) == output_dir, result,
+                        "CurveMeshBaker: the output directory must differ "
+                        "from the input directory.");
+    const Error dir_err = DirAccess::make_dir_recursive_absolute(p_output_dir);
+    ERR_FAIL_COND_V_MSG(dir_err != OK, result,
+                        "CurveMeshBaker: cannot create '" + p_output_dir +
+                            "'.");
+
+    PackedStringArray inputs;
+    _collect_inputs(p_input_dir, String(), output_dir, inputs);
+
+    const String manifest_path = p_output_dir.path_join(MANIFEST_NAME);
+    const Dictionary previous_manifest =
+        force ? Dictionary() : _load_manifest(manifest_path);
+    Dictionary manifest;
+    HashSet<String> output_paths;
+
+    int baked = 0;
+    int skipped = 0;
+    int ignored = 0;
+    int failed = 0;
+    for (int64_t begin = 0; begin < inputs.size(); begin += batch_size)
+    {
+        // Inputs are loaded and snapshotted on the main thread; only the
+        // generation itself runs on the workers.
+        jobs.clear();
+        const int64_t end = Math::min(begin + batch_size, inputs.size());
+        for (int64_t i = begin; i < end; i++)
+        {
+            Job job;
+            job.key = inputs[i];
+            job.input_path = p_input_dir.path_join(job.key);
+            job.output_path =
+                p_output_dir.path_join(job.key.get_basename() + ".res");
+            job.fingerprint = _get_fingerprint(job.input_path);
+
+            const String previous = previous_manifest.get(job.key, String());
+            const String ignored_fingerprint = IGNORED_PREFIX + job.fingerprint;
+            if (previous == ignored_fingerprint)
+            {
+                manifest[job.key] = ignored_fingerprint;
+                ignored++;
+                continue;
+            }
+
+            // a.tres and a.res would both be saved as a.res, so only the
+            // first one in the walk is baked.
+            if (output_paths.has(job.output_path))
+            {
+                ERR_PRINT("CurveMeshBaker: '" + job.input_path +
+                          "' has the same output as another input, '" +
+                          job.output_path + "'.");
+                failed++;
+                continue;
+            }
+
+            if (FileAccess::file_exists(job.output_path) &&
+                previous == job.fingerprint)
+            {
+                output_paths.insert(job.output_path);
+                manifest[job.key] = job.fingerprint;
+                skipped++;
+                continue;
+            }
+
+            const Error err = _load_mesh(job.input_path, job.mesh);
+            if (err == ERR_FILE_UNRECOGNIZED)
+            {
+                manifest[job.key] = ignored_fingerprint;
+                ignored++;
+                continue;
+            }
+            output_paths.insert(job.output_path);
+            if (err != OK)
+            {
+                failed++;
+                continue;
+            }
+
+            jobs.push_back(job);
+            Job &queued = jobs[jobs.size() - 1];
+            queued.mesh->prepare_build(queued.build);
+        }
+
+        if (!jobs.is_empty())
+        {
+            WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+            const int64_t task = pool->add_group_task(
+                callable_mp(this, &CurveMeshBaker::_bake_at), jobs.size(), -1,
+                true, "CurveMeshBaker bake");
+            pool->wait_for_group_task_completion(task);
+        }
+
+        for (Job &job : jobs)
+        {
+            if (_save_job(job))
+            {
+                manifest[job.key] = job.fingerprint;
+                baked++;
+            }
+            else
+            {
+                failed++;
+            }
+        }
+        jobs.clear();
+
+        // Written after every batch, so an interrupted run keeps the meshes
+        // it already baked.
+        _save_manifest(manifest_path, manifest);
+    }
+
+    result["baked"] = baked;
+    result["skipped"] = skipped;
+    result["ignored"] = ignored;
+    result["failed"] = failed;
+    return result;
+}
+
+void CurveMeshBaker::set_generate_lods(bool p_enable)
+{
+    generate_lods = p_enable;
+}
+
+bool CurveMeshBaker::is_generate_lods() const { return generate_lods; }
+
+void CurveMeshBaker::set_compress_attributes(bool p_enable)
+{
+    compress_attributes = p_enable;
+}
+
+bool CurveMeshBaker::is_compress_attributes() const
+{
+    return compress_attributes;
+}
+
+void CurveMeshBaker::set_force(bool p_enable) { force = p_enable; }
+
+bool CurveMeshBaker::is_force() const { return force; }
+
+void CurveMeshBaker::set_batch_size(int p_size)
+{
+    batch_size = Math::max(p_size, 1);
+}
+
+int CurveMeshBaker::get_batch_size() const { return batch_size; }
+
+void CurveMeshBaker::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("bake_directory", "input_dir", "output_dir"),
+                         &CurveMeshBaker::bake_directory);
+
+    ClassDB::bind_method(D_METHOD("set_generate_lods", "enable"),
+                         &CurveMeshBaker::set_generate_lods);
+    ClassDB::bind_method(D_METHOD("is_generate_lods"),
+                         &CurveMeshBaker::is_generate_lods);
+    ClassDB::bind_method(D_METHOD("set_compress_attributes", "enable"),
+                         &CurveMeshBaker::set_compress_attributes);
+    ClassDB::bind_method(D_METHOD("is_compress_attributes"),
+                         &CurveMeshBaker::is_compress_attributes);
+    ClassDB::bind_method(D_METHOD("set_force", "enable"),
+                         &CurveMeshBaker::set_force);
+    ClassDB::bind_method(D_METHOD("is_force"), &CurveMeshBaker::is_force);
+    ClassDB::bind_method(D_METHOD("set_batch_size", "size"),
+                         &CurveMeshBaker::set_batch_size);
+    ClassDB::bind_method(D_METHOD("get_batch_size"),
+                         &CurveMeshBaker::get_batch_size);
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "generate_lods"),
+                 "set_generate_lods", "is_generate_lods");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compress_attributes"),
+                 "set_compress_attributes", "is_compress_attributes");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "force"), "set_force",
+                 "is_force");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_size", PROPERTY_HINT_RANGE,
+                              "1,1024,1,or_greater"),
+                 "set_batch_size", "get_batch_size");
+}
+
+} // namespace godot
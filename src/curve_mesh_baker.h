@@ -0,0 +1,72 @@
+#ifndef CURVE_MESH_BAKER_H
+#define CURVE_MESH_BAKER_H
+
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/importer_mesh.hpp>
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/string.hpp>
+
+namespace godot
+{
+
+// Bakes a directory of Curve3D and CurveMesh resources into ArrayMesh files.
+// Inputs are loaded on the main thread and generated in parallel on the
+// WorkerThreadPool. A manifest in the output directory records a fingerprint
+// of every input, so unchanged inputs are skipped on the next run.
+class CurveMeshBaker : public RefCounted
+{
+    GDCLASS(CurveMeshBaker, RefCounted);
+
+  private:
+    struct Job
+    {
+        String input_path;
+        String output_path;
+        String key;
+        String fingerprint;
+        Ref<CurveMesh> mesh;
+        CurveMesh::BackgroundBuild build;
+        Ref<ImporterMesh> lod_mesh;
+    };
+
+    bool generate_lods = false;
+    bool compress_attributes = false;
+    bool force = false;
+    int batch_size = 64;
+
+    LocalVector<Job> jobs;
+
+  private:
+    String _get_fingerprint(const String &p_path) const;
+    uint64_t _get_surface_flags() const;
+    Error _load_mesh(const String &p_path, Ref<CurveMesh> &r_mesh) const;
+    void _bake_at(uint32_t p_index);
+    bool _save_job(Job &r_job) const;
+
+  protected:
+    static void _bind_methods();
+
+  public:
+    Dictionary bake_directory(const String &p_input_dir,
+                              const String &p_output_dir);
+
+    void set_generate_lods(bool p_enable);
+    bool is_generate_lods() const;
+
+    void set_compress_attributes(bool p_enable);
+    bool is_compress_attributes() const;
+
+    void set_force(bool p_enable);
+    bool is_force() const;
+
+    void set_batch_size(int p_size);
+    int get_batch_size() const;
+};
+
+} // namespace godot
+
+#endif // CURVE_MESH_BAKER_H
@@ -0,0 +1,687 @@
+#include "curve_mesh_exporter.h"
+
+#include <godot_cpp/classes/dir_access.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/json.hpp>
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/array.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace godot
+{
+
+namespace
+{
+// Size of the blocks copied between files and of the OBJ text buffer.
+constexpr int64_t BLOCK_SIZE = 1 << 20;
+
+constexpr int GLTF_FLOAT = 5126;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_ARRAY_BUFFER = 34962;
+constexpr int GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+constexpr int GLTF_TRIANGLES = 4;
+
+constexpr uint32_t GLB_MAGIC = 0x46546C67;
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+static Array _make_vector(const Vector3 &p_vector)
+{
+    Array array;
+    array.push_back(p_vector.x);
+    array.push_back(p_vector.y);
+    array.push_back(p_vector.z);
+    return array;
+}
+
+// glTF defines the bitangent as cross(normal, tangent.xyz) * w, pointing
+// along increasing V. The sign is taken from the UV layout of the triangles
+// around each vertex rather than copied, so it stays right after the
+// winding is swapped. Vertices without a usable UV gradient keep their w.
+static void _fix_tangent_signs(const Array &p_arrays, int p_index_count,
+                               float *r_tangents)
+{
+    const PackedVector3Array vertices = p_arrays[Mesh::ARRAY_VERTEX];
+    const PackedVector3Array normals = p_arrays[Mesh::ARRAY_NORMAL];
+    const PackedVector2Array uvs = p_arrays[Mesh::ARRAY_TEX_UV];
+    const PackedInt32Array indices = p_arrays[Mesh::ARRAY_INDEX];
+    const int vertex_count = vertices.size();
+    if (normals.size() != vertex_count || uvs.size() != vertex_count)
+    {
+        return;
+    }
+
+    LocalVector<Vector3> bitangents;
+    bitangents.resize(vertex_count);
+    for (int i = 0; i < p_index_count; i += 3)
+    {
+        const int a = indices[i + 0];
+        const int b = indices[i + 1];
+        const int c = indices[i + 2];
+        const Vector3 edge1 = vertices[b] - vertices[a];
+        const Vector3 edge2 = vertices[c] - vertices[a];
+        const Vector2 delta1 = uvs[b] - uvs[a];
+        const Vector2 delta2 = uvs[c] - uvs[a];
+        const float area = delta1.x * delta2.y - delta2.x * delta1.y;
+        if (Math::is_zero_approx(area))
+        {
+            continue;
+        }
+        const Vector3 bitangent = (edge2 * delta1.x - edge1 * delta2.x) / area;
+        bitangents[a] += bitangent;
+        bitangents[b] += bitangent;
+        bitangents[c] += bitangent;
+    }
+
+    for (int i = 0; i < vertex_count; i++)
+    {
+        float *tangent = r_tangents + i * 4;
+        const float side =
+            normals[i]
+                .cross(Vector3(tangent[0], tangent[1], tangent[2]))
+                .dot(bitangents[i]);
+        if (!Math::is_zero_approx(side))
+        {
+            tangent[3] = (side < 0.0f) ? -1.0f : 1.0f;
+        }
+    }
+}
+
+// Streams the vertex data of each mesh straight into the binary buffer and
+// keeps only the accessor and node descriptions, which are written at the
+// end. A .glb needs its JSON before the buffer, so the buffer goes to a
+// temporary file first and is copied behind the JSON in finish().
+class GltfWriter
+{
+  public:
+    Error open(const String &p_path)
+    {
+        path = p_path;
+        binary = p_path.get_extension().to_lower() != "gltf";
+        buffer_path =
+            binary ? p_path + ".tmp" : p_path.get_basename() + ".bin";
+        buffer_file = FileAccess::open(buffer_path, FileAccess::WRITE);
+        return buffer_file.is_valid() ? OK : FileAccess::get_open_error();
+    }
+
+    Error write_mesh(const Array &p_arrays, const Transform3D &p_transform)
+    {
+        const PackedVector3Array vertices = p_arrays[Mesh::ARRAY_VERTEX];
+        const PackedInt32Array indices = p_arrays[Mesh::ARRAY_INDEX];
+        const int vertex_count = vertices.size();
+        if (vertex_count == 0 || indices.size() < 3)
+        {
+            return OK;
+        }
+
+        Dictionary attributes;
+        Vector3 min_position = vertices[0];
+        Vector3 max_position = vertices[0];
+        float *out = _begin_view(vertex_count * 3);
+        for (int i = 0; i < vertex_count; i++)
+        {
+            const Vector3 &vertex = vertices[i];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                out[i * 3 + axis] = vertex[axis];
+                min_position[axis] = Math::min(min_position[axis],
+                                               vertex[axis]);
+                max_position[axis] = Math::max(max_position[axis],
+                                               vertex[axis]);
+            }
+        }
+        Dictionary position = _add_accessor(
+            _store_view(GLTF_ARRAY_BUFFER), GLTF_FLOAT, vertex_count, "VEC3");
+        position["min"] = _make_vector(min_position);
+        position["max"] = _make_vector(max_position);
+        attributes["POSITION"] = accessors.size() - 1;
+
+        const PackedVector3Array normals = p_arrays[Mesh::ARRAY_NORMAL];
+        if (normals.size() == vertex_count)
+        {
+            out = _begin_view(vertex_count * 3);
+            for (int i = 0; i < vertex_count; i++)
+            {
+                out[i * 3 + 0] = normals[i].x;
+                out[i * 3 + 1] = normals[i].y;
+                out[i * 3 + 2] = normals[i].z;
+            }
+            _add_accessor(_store_view(GLTF_ARRAY_BUFFER), GLTF_FLOAT,
+                          vertex_count, "VEC3");
+            attributes["NORMAL"] = accessors.size() - 1;
+        }
+
+        const PackedFloat32Array tangents = p_arrays[Mesh::ARRAY_TANGENT];
+        if (tangents.size() == vertex_count * 4)
+        {
+            out = _begin_view(vertex_count * 4);
+            memcpy(out, tangents.ptr(), vertex_count * 4 * sizeof(float));
+            _fix_tangent_signs(p_arrays, indices.size() - indices.size() % 3,
+                               out);
+            _add_accessor(_store_view(GLTF_ARRAY_BUFFER), GLTF_FLOAT,
+                          vertex_count, "VEC4");
+            attributes["TANGENT"] = accessors.size() - 1;
+        }
+
+        static const char *uv_names[2] = {"TEXCOORD_0", "TEXCOORD_1"};
+        static const int uv_arrays[2] = {Mesh::ARRAY_TEX_UV,
+                                         Mesh::ARRAY_TEX_UV2};
+        for (int channel = 0; channel < 2; channel++)
+        {
+            const PackedVector2Array uvs = p_arrays[uv_arrays[channel]];
+            if (uvs.size() != vertex_count)
+            {
+                continue;
+            }
+            out = _begin_view(vertex_count * 2);
+            for (int i = 0; i < vertex_count; i++)
+            {
+                out[i * 2 + 0] = uvs[i].x;
+                out[i * 2 + 1] = uvs[i].y;
+            }
+            _add_accessor(_store_view(GLTF_ARRAY_BUFFER), GLTF_FLOAT,
+                          vertex_count, "VEC2");
+            attributes[uv_names[channel]] = accessors.size() - 1;
+        }
+
+        // glTF front faces wind counter-clockwise, Godot's clockwise.
+        const int index_count = indices.size() - indices.size() % 3;
+        uint32_t *index_out = (uint32_t *)_begin_view(index_count);
+        for (int i = 0; i < index_count; i += 3)
+        {
+            index_out[i + 0] = indices[i + 0];
+            index_out[i + 1] = indices[i + 2];
+            index_out[i + 2] = indices[i + 1];
+        }
+        _add_accessor(_store_view(GLTF_ELEMENT_ARRAY_BUFFER),
+                      GLTF_UNSIGNED_INT, index_count, "SCALAR");
+
+        Dictionary primitive;
+        primitive["attributes"] = attributes;
+        primitive["indices"] = accessors.size() - 1;
+        primitive["mode"] = GLTF_TRIANGLES;
+        Array primitives;
+        primitives.push_back(primitive);
+        Dictionary mesh;
+        mesh["primitives"] = primitives;
+        meshes.push_back(mesh);
+
+        Dictionary node;
+        node["mesh"] = meshes.size() - 1;
+        if (p_transform != Transform3D())
+        {
+            Array matrix;
+            for (int column = 0; column < 3; column++)
+            {
+                const Vector3 axis = p_transform.basis.get_column(column);
+                matrix.push_back(axis.x);
+                matrix.push_back(axis.y);
+                matrix.push_back(axis.z);
+                matrix.push_back(0.0);
+            }
+            matrix.push_back(p_transform.origin.x);
+            matrix.push_back(p_transform.origin.y);
+            matrix.push_back(p_transform.origin.z);
+            matrix.push_back(1.0);
+            node["matrix"] = matrix;
+        }
+        nodes.push_back(node);
+
+        return buffer_file->get_error();
+    }
+
+    Error finish()
+    {
+        buffer_file->close();
+        buffer_file.unref();
+
+        const String json = JSON::stringify(_make_document(), "", false);
+        if (!binary)
+        {
+            Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+            ERR_FAIL_COND_V_MSG(file.is_null(), FileAccess::get_open_error(),
+                                "Cannot open '" + path + "' for writing.");
+            file->store_string(json);
+            return file->get_error();
+        }
+
+        Error err = _write_glb(json);
+        DirAccess::remove_absolute(buffer_path);
+        return err;
+    }
+
+    void abort()
+    {
+        buffer_file.unref();
+        DirAccess::remove_absolute(buffer_path);
+    }
+
+  private:
+    String path;
+    String buffer_path;
+    bool binary = true;
+    Ref<FileAccess> buffer_file;
+    uint64_t buffer_length = 0;
+    PackedByteArray staging;
+
+    Array meshes;
+    Array nodes;
+    Array accessors;
+    Array buffer_views;
+
+    float *_begin_view(int p_count)
+    {
+        staging.resize(p_count * 4);
+        return (float *)staging.ptrw();
+    }
+
+    int _store_view(int p_target)
+    {
+        buffer_file->store_buffer(staging);
+
+        Dictionary view;
+        view["buffer"] = 0;
+        view["byteOffset"] = (int64_t)buffer_length;
+        view["byteLength"] = staging.size();
+        view["target"] = p_target;
+        buffer_views.push_back(view);
+
+        // Every view holds 4-byte components, so offsets stay aligned.
+        buffer_length += staging.size();
+        return buffer_views.size() - 1;
+    }
+
+    Dictionary _add_accessor(int p_view, int p_component_type, int p_count,
+                             const String &p_type)
+    {
+        Dictionary accessor;
+        accessor["bufferView"] = p_view;
+        accessor["componentType"] = p_component_type;
+        accessor["count"] = p_count;
+        accessor["type"] = p_type;
+        accessors.push_back(accessor);
+        return accessor;
+    }
+
+    Dictionary _make_document() const
+    {
+        Dictionary asset;
+        asset["version"] = "2.0";
+        asset["generator"] = "CurveMeshExporter";
+
+        Array scene_nodes;
+        for (int64_t i = 0; i < nodes.size(); i++)
+        {
+            scene_nodes.push_back(i);
+        }
+        Dictionary scene;
+        if (!scene_nodes.is_empty())
+        {
+            scene["nodes"] = scene_nodes;
+        }
+        Array scenes;
+        scenes.push_back(scene);
+
+        Dictionary document;
+        document["asset"] = asset;
+        document["scene"] = 0;
+        document["scenes"] = scenes;
+        if (buffer_length == 0)
+        {
+            // glTF forbids empty arrays and buffers.
+            return document;
+        }
+
+        Dictionary buffer;
+        buffer["byteLength"] = (int64_t)buffer_length;
+        if (!binary)
+        {
+            buffer["uri"] = buffer_path.get_file();
+        }
+        Array buffers;
+        buffers.push_back(buffer);
+
+        document["nodes"] = nodes;
+        document["meshes"] = meshes;
+        document["accessors"] = accessors;
+        document["bufferViews"] = buffer_views;
+        document["buffers"] = buffers;
+        return document;
+    }
+
+    Error _write_glb(const String &p_json)
+    {
+        const CharString json_utf8 = p_json.utf8();
+        const int64_t json_length = json_utf8.length();
+        PackedByteArray json_chunk;
+        json_chunk.resize((json_length + 3) & ~int64_t(3));
+        json_chunk.fill(' ');
+        memcpy(json_chunk.ptrw(), json_utf8.get_data(), json_length);
+
+        uint64_t total_length = 12 + 8 + json_chunk.size();
+        if (buffer_length > 0)
+        {
+            total_length += 8 + buffer_length;
+        }
+        ERR_FAIL_COND_V_MSG(total_length > UINT32_MAX, ERR_FILE_CANT_WRITE,
+                            "The export exceeds the 4 GiB limit of .glb "
+                            "files; export to .gltf instead.");
+
+        Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+        ERR_FAIL_COND_V_MSG(file.is_null(), FileAccess::get_open_error(),
+                            "Cannot open '" + path + "' for writing.");
+        file->store_32(GLB_MAGIC);
+        file->store_32(2);
+        file->store_32((uint32_t)total_length);
+        file->store_32((uint32_t)json_chunk.size());
+        file->store_32(GLB_CHUNK_JSON);
+        file->store_buffer(json_chunk);
+        if (buffer_length == 0)
+        {
+            return file->get_error();
+        }
+
+        Ref<FileAccess> buffer =
+            FileAccess::open(buffer_path, FileAccess::READ);
+        ERR_FAIL_COND_V_MSG(buffer.is_null(), FileAccess::get_open_error(),
+                            "Cannot reopen '" + buffer_path + "'.");
+        file->store_32((uint32_t)buffer_length);
+        file->store_32(GLB_CHUNK_BIN);
+        for (uint64_t copied = 0; copied < buffer_length;)
+        {
+            const PackedByteArray block = buffer->get_buffer(
+                Math::min<int64_t>(BLOCK_SIZE, buffer_length - copied));
+            ERR_FAIL_COND_V(block.is_empty(), ERR_FILE_CANT_READ);
+            file->store_buffer(block);
+            copied += block.size();
+        }
+        return file->get_error();
+    }
+};
+
+// Bakes the transform of each mesh into its vertices, since OBJ has no
+// per-object transforms. Lines are formatted into a fixed-size block that is
+// flushed to the file whenever it fills up.
+class ObjWriter
+{
+  public:
+    Error open(const String &p_path)
+    {
+        file = FileAccess::open(p_path, FileAccess::WRITE);
+        if (file.is_null())
+        {
+            return FileAccess::get_open_error();
+        }
+        buffer.resize(BLOCK_SIZE);
+        _print("# CurveMeshExporter\n");
+        return OK;
+    }
+
+    Error write_mesh(const Array &p_arrays, const Transform3D &p_transform)
+    {
+        const PackedVector3Array vertices = p_arrays[Mesh::ARRAY_VERTEX];
+        const PackedVector3Array normals = p_arrays[Mesh::ARRAY_NORMAL];
+        const PackedVector2Array uvs = p_arrays[Mesh::ARRAY_TEX_UV];
+        const PackedInt32Array indices = p_arrays[Mesh::ARRAY_INDEX];
+        const int vertex_count = vertices.size();
+        if (vertex_count == 0 || indices.size() < 3)
+        {
+            return OK;
+        }
+
+        _print("o curve_%d\n", object_count++);
+        for (int i = 0; i < vertex_count; i++)
+        {
+            const Vector3 vertex = p_transform.xform(vertices[i]);
+            _print("v %.6g %.6g %.6g\n", vertex.x, vertex.y, vertex.z);
+        }
+
+        const bool has_normals = normals.size() == vertex_count;
+        if (has_normals)
+        {
+            const Basis normal_basis = p_transform.basis.inverse().transposed();
+            for (int i = 0; i < vertex_count; i++)
+            {
+                const Vector3 normal =
+                    normal_basis.xform(normals[i]).normalized();
+                _print("vn %.6g %.6g %.6g\n", normal.x, normal.y, normal.z);
+            }
+        }
+
+        // OBJ puts the UV origin at the bottom left.
+        const bool has_uvs = uvs.size() == vertex_count;
+        if (has_uvs)
+        {
+            for (int i = 0; i < vertex_count; i++)
+            {
+                _print("vt %.6g %.6g\n", uvs[i].x, 1.0f - uvs[i].y);
+            }
+        }
+
+        // OBJ front faces wind counter-clockwise, Godot's clockwise, unless
+        // a mirroring transform already flipped them.
+        const bool flip = p_transform.basis.determinant() > 0.0f;
+        const int index_count = indices.size() - indices.size() % 3;
+        for (int i = 0; i < index_count; i += 3)
+        {
+            const int64_t a = vertex_offset + indices[i];
+            const int64_t b = vertex_offset + indices[flip ? i + 2 : i + 1];
+            const int64_t c = vertex_offset + indices[flip ? i + 1 : i + 2];
+            if (has_normals && has_uvs)
+            {
+                _print("f %lld/%lld/%lld %lld/%lld/%lld %lld/%lld/%lld\n",
+                       (long long)a, (long long)a, (long long)a,
+                       (long long)b, (long long)b, (long long)b,
+                       (long long)c, (long long)c, (long long)c);
+            }
+            else if (has_normals)
+            {
+                _print("f %lld//%lld %lld//%lld %lld//%lld\n", (long long)a,
+                       (long long)a, (long long)b, (long long)b,
+                       (long long)c, (long long)c);
+            }
+            else
+            {
+                _print("f %lld %lld %lld\n", (long long)a, (long long)b,
+                       (long long)c);
+            }
+        }
+
+        // Normals and UVs are only written alongside vertices, so the three
+        // streams keep the same numbering.
+        vertex_offset += vertex_count;
+        return file->get_error();
+    }
+
+    Error finish()
+    {
+        _flush();
+        return file->get_error();
+    }
+
+    void abort() { file.unref(); }
+
+  private:
+    Ref<FileAccess> file;
+    PackedByteArray buffer;
+    int64_t used = 0;
+    int64_t vertex_offset = 1;
+    int object_count = 0;
+
+    void _print(const char *p_format, ...)
+    {
+        char line[256];
+        va_list args;
+        va_start(args, p_format);
+        const int length = vsnprintf(line, sizeof(line), p_format, args);
+        va_end(args);
+        if (length <= 0)
+        {
+            return;
+        }
+
+        if (used + length > buffer.size())
+        {
+            _flush();
+        }
+        memcpy(buffer.ptrw() + used, line, length);
+        used += length;
+    }
+
+    void _flush()
+    {
+        if (used == buffer.size())
+        {
+            file->store_buffer(buffer);
+        }
+        else if (used > 0)
+        {
+            file->store_buffer(buffer.slice(0, used));
+        }
+        used = 0;
+    }
+};
+} // namespace
+
+int64_t CurveMeshExporter::_start_batch(int p_batch, uint32_t p_begin)
+{
+    LocalVector<CurveMesh::BackgroundBuild> &builds = batches[p_batch];
+    const uint32_t count =
+        Math::min((uint32_t)batch_size, entries.size() - p_begin);
+    builds.resize(count);
+
+    // Snapshots read the Curve3D resources, so they are taken here on the
+    // main thread.
+    for (uint32_t i = 0; i < count; i++)
+    {
+        entries[p_begin + i].mesh->prepare_build(builds[i]);
+    }
+
+    building_batch = p_batch;
+    building_begin = p_begin;
+    return WorkerThreadPool::get_singleton()->add_group_task(
+        callable_mp(this, &CurveMeshExporter::_build_at), count, -1, true,
+        "CurveMeshExporter build");
+}
+
+void CurveMeshExporter::_build_at(uint32_t p_index)
+{
+    const Entry &entry = entries[building_begin + p_index];
+    entry.mesh->run_build(batches[building_batch][p_index]);
+}
+
+template <typename Writer>
+Error CurveMeshExporter::_write_batches(Writer &p_writer)
+{
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    const uint32_t count = entries.size();
+    int current = 0;
+    int64_t task = count > 0 ? _start_batch(current, 0) : -1;
+
+    for (uint32_t begin = 0; begin < count; begin += batch_size)
+    {
+        pool->wait_for_group_task_completion(task);
+
+        // The next batch builds while this one is written out.
+        const uint32_t next = begin + batch_size;
+        task = next < count ? _start_batch(1 - current, next) : -1;
+
+        LocalVector<CurveMesh::BackgroundBuild> &builds = batches[current];
+        Error err = OK;
+        for (uint32_t i = 0; i < builds.size() && err == OK; i++)
+        {
+            err = p_writer.write_mesh(builds[i].arrays,
+                                      entries[begin + i].transform);
+            builds[i] = CurveMesh::BackgroundBuild();
+        }
+        builds.clear();
+
+        if (err != OK)
+        {
+            if (task >= 0)
+            {
+                pool->wait_for_group_task_completion(task);
+            }
+            batches[1 - current].clear();
+            p_writer.abort();
+            return err;
+        }
+        current = 1 - current;
+    }
+
+    return p_writer.finish();
+}
+
+void CurveMeshExporter::add_mesh(const Ref<CurveMesh> &p_mesh,
+                                 const Transform3D &p_transform)
+{
+    ERR_FAIL_COND(p_mesh.is_null());
+    Entry entry;
+    entry.mesh = p_mesh;
+    entry.transform = p_transform;
+    entries.push_back(entry);
+}
+
+void CurveMeshExporter::clear() { entries.clear(); }
+
+int CurveMeshExporter::get_mesh_count() const { return entries.size(); }
+
+void CurveMeshExporter::set_batch_size(int p_size)
+{
+    batch_size = Math::max(p_size, 1);
+}
+
+int CurveMeshExporter::get_batch_size() const { return batch_size; }
+
+Error CurveMeshExporter::export_gltf(const String &p_path)
+{
+    GltfWriter writer;
+    const Error err = writer.open(p_path);
+    ERR_FAIL_COND_V_MSG(err != OK, err,
+                        "Cannot open '" + p_path + "' for writing.");
+    return _write_batches(writer);
+}
+
+Error CurveMeshExporter::export_obj(const String &p_path)
+{
+    ObjWriter writer;
+    const Error err = writer.open(p_path);
+    ERR_FAIL_COND_V_MSG(err != OK, err,
+                        "Cannot open '" + p_path + "' for writing.");
+    return _write_batches(writer);
+}
+
+void CurveMeshExporter::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("add_mesh", "mesh", "transform"),
+                         &CurveMeshExporter::add_mesh,
+                         DEFVAL(Transform3D()));
+    ClassDB::bind_method(D_METHOD("clear"), &CurveMeshExporter::clear);
+    ClassDB::bind_method(D_METHOD("get_mesh_count"),
+                         &CurveMeshExporter::get_mesh_count);
+
+    ClassDB::bind_method(D_METHOD("set_batch_size", "size"),
+                         &CurveMeshExporter::set_batch_size);
+    ClassDB::bind_method(D_METHOD("get_batch_size"),
+                         &CurveMeshExporter::get_batch_size);
+
+    ClassDB::bind_method(D_METHOD("export_gltf", "path"),
+                         &CurveMeshExporter::export_gltf);
+    ClassDB::bind_method(D_METHOD("export_obj", "path"),
+                         &CurveMeshExporter::export_obj);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "batch_size", PROPERTY_HINT_RANGE,
+                              "1,256,1,or_greater"),
+                 "set_batch_size", "get_batch_size");
+}
+
+} // namespace godot
@@ -0,0 +1,60 @@
+#ifndef CURVE_MESH_EXPORTER_H
+#define CURVE_MESH_EXPORTER_H
+
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/string.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace godot
+{
+
+// Writes many CurveMeshes into one glTF or OBJ file without holding them
+// all in memory. Meshes are built on the WorkerThreadPool a batch at a time,
+// and each batch is written out and freed while the next one builds.
+class CurveMeshExporter : public RefCounted
+{
+    GDCLASS(CurveMeshExporter, RefCounted);
+
+  private:
+    struct Entry
+    {
+        Ref<CurveMesh> mesh;
+        Transform3D transform;
+    };
+
+    LocalVector<Entry> entries;
+    int batch_size = 16;
+
+    // One batch is built on worker threads while the other is written.
+    LocalVector<CurveMesh::BackgroundBuild> batches[2];
+    int building_batch = 0;
+    uint32_t building_begin = 0;
+
+  private:
+    int64_t _start_batch(int p_batch, uint32_t p_begin);
+    void _build_at(uint32_t p_index);
+    template <typename Writer> Error _write_batches(Writer &p_writer);
+
+  protected:
+    static void _bind_methods();
+
+  public:
+    void add_mesh(const Ref<CurveMesh> &p_mesh,
+                  const Transform3D &p_transform = Transform3D());
+    void clear();
+    int get_mesh_count() const;
+
+    void set_batch_size(int p_size);
+    int get_batch_size() const;
+
+    Error export_gltf(const String &p_path);
+    Error export_obj(const String &p_path);
+};
+
+} // namespace godot
+
+#endif // CURVE_MESH_EXPORTER_H
@@ -0,0 +1,25 @@
+#include "curve_mesh_profiler.h"
+
+#if defined(CURVE_MESH_PROFILE_PERFETTO)
+PERFETTO_TRACK_EVENT_STATIC_STORAGE();
+#endif
+
+namespace godot
+{
+
+void initialize_curve_mesh_profiler()
+{
+#if defined(CURVE_MESH_PROFILE_PERFETTO)
+    // The host normally sets up tracing itself. If it has not, events go to
+    // the system tracing service, where the Perfetto UI can record them.
+    if (!perfetto::Tracing::IsInitialized())
+    {
+        perfetto::TracingInitArgs args;
+        args.backends = perfetto::kSystemBackend;
+        perfetto::Tracing::Initialize(args);
+    }
+    perfetto::TrackEvent::Register();
+#endif
+}
+
+} // namespace godot
@@ -0,0 +1,61 @@
+#ifndef CURVE_MESH_PROFILER_H
+#define CURVE_MESH_PROFILER_H
+
+// Instrumentation for external profilers, chosen at build time with
+// "scons profiler=tracy" or "scons profiler=perfetto". Without either, every
+// macro expands to nothing and no profiler header is included.
+//
+// CURVE_MESH_PROFILE_ZONE(name)       scoped zone until the end of the block
+// CURVE_MESH_PROFILE_ALLOC(ptr, size) scratch buffer of size bytes at ptr
+// CURVE_MESH_PROFILE_FREE(ptr)        scratch buffer at ptr released
+// CURVE_MESH_PROFILE_PLOT(name, v)    sample of the counter name
+//
+// Names must be string literals.
+
+#if defined(CURVE_MESH_PROFILE_TRACY)
+
+#include <tracy/Tracy.hpp>
+
+#define CURVE_MESH_PROFILE_ZONE(m_name) ZoneScopedN(m_name)
+#define CURVE_MESH_PROFILE_ALLOC(m_ptr, m_size)                               \
+    TracyAllocN(m_ptr, m_size, "CurveMesh scratch")
+#define CURVE_MESH_PROFILE_FREE(m_ptr) TracyFreeN(m_ptr, "CurveMesh scratch")
+#define CURVE_MESH_PROFILE_PLOT(m_name, m_value)                              \
+    TracyPlot(m_name, (int64_t)(m_value))
+
+#elif defined(CURVE_MESH_PROFILE_PERFETTO)
+
+#include <perfetto.h>
+
+PERFETTO_DEFINE_CATEGORIES(
+    perfetto::Category("curve_mesh").SetDescription("CurveMesh generation"));
+
+#define CURVE_MESH_PROFILE_ZONE(m_name) TRACE_EVENT("curve_mesh", m_name)
+#define CURVE_MESH_PROFILE_ALLOC(m_ptr, m_size)                               \
+    TRACE_EVENT_INSTANT("curve_mesh", "scratch alloc", "ptr",                 \
+                        (uint64_t)(uintptr_t)(m_ptr), "bytes",                \
+                        (uint64_t)(m_size))
+#define CURVE_MESH_PROFILE_FREE(m_ptr)                                        \
+    TRACE_EVENT_INSTANT("curve_mesh", "scratch free", "ptr",                  \
+                        (uint64_t)(uintptr_t)(m_ptr))
+#define CURVE_MESH_PROFILE_PLOT(m_name, m_value)                              \
+    TRACE_COUNTER("curve_mesh", m_name, (int64_t)(m_value))
+
+#else
+
+#define CURVE_MESH_PROFILE_ZONE(m_name)
+#define CURVE_MESH_PROFILE_ALLOC(m_ptr, m_size)
+#define CURVE_MESH_PROFILE_FREE(m_ptr)
+#define CURVE_MESH_PROFILE_PLOT(m_name, m_value)
+
+#endif
+
+namespace godot
+{
+
+// Registers the trace categories with the profiler, if it needs that.
+void initialize_curve_mesh_profiler();
+
+} // namespace godot
+
+#endif // CURVE_MESH_PROFILER_H
@@ -0,0 +1,601 @@
+#include "curve_mesh_scheduler.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <godot_cpp/classes/window.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/core/object.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace godot
+{
+
+namespace
+{
+// Ordering key of a queued mesh or a finished job. Meshes in view come
+// first, each group sorted by distance to the camera. Ties keep the queue
+// order, so meshes without a camera or a node are built first come, first
+// served.
+struct ScheduleEntry
+{
+    bool hidden = false;
+    float distance = 0.0f;
+    int index = 0;
+
+    bool operator<(const ScheduleEntry &p_other) const
+    {
+        if (hidden != p_other.hidden)
+        {
+            return !hidden;
+        }
+        if (distance != p_other.distance)
+        {
+            return distance < p_other.distance;
+        }
+        return index < p_other.index;
+    }
+};
+
+static bool _is_in_frustum(const AABB &p_aabb,
+                           const TypedArray<Plane> &p_frustum)
+{
+    // The box is outside as soon as its corner furthest against a plane
+    // normal is still in front of that plane.
+    for (int64_t i = 0; i < p_frustum.size(); i++)
+    {
+        const Plane plane = p_frustum[i];
+        Vector3 corner = p_aabb.position;
+        if (plane.normal.x < 0.0f)
+        {
+            corner.x += p_aabb.size.x;
+        }
+        if (plane.normal.y < 0.0f)
+        {
+            corner.y += p_aabb.size.y;
+        }
+        if (plane.normal.z < 0.0f)
+        {
+            corner.z += p_aabb.size.z;
+        }
+        if (plane.distance_to(corner) > 0.0f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+CurveMeshScheduler *CurveMeshScheduler::singleton = nullptr;
+
+CurveMeshScheduler::CurveMeshScheduler() { singleton = this; }
+
+CurveMeshScheduler::~CurveMeshScheduler()
+{
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        Job &job = jobs[slot];
+        if (job.task >= 0)
+        {
+            pool->wait_for_task_completion(job.task);
+            job.task = -1;
+        }
+        job.mesh.unref();
+    }
+    queue.clear();
+    queued_meshes.clear();
+
+    if (singleton == this)
+    {
+        singleton = nullptr;
+    }
+}
+
+CurveMeshScheduler *CurveMeshScheduler::get_singleton() { return singleton; }
+
+bool CurveMeshScheduler::_connect_to_tree()
+{
+    if (connected)
+    {
+        return true;
+    }
+
+    Engine *engine = Engine::get_singleton();
+    SceneTree *tree = Object::cast_to<SceneTree>(engine->get_main_loop());
+    if (tree == nullptr)
+    {
+        return false;
+    }
+
+    tree->connect("process_frame",
+                  callable_mp(this, &CurveMeshScheduler::_process_frame));
+    tree->connect("node_added",
+                  callable_mp(this, &CurveMeshScheduler::_on_node_added));
+    connected = true;
+    return true;
+}
+
+Camera3D *CurveMeshScheduler::_get_camera() const
+{
+    if (camera_id != 0)
+    {
+        return Object::cast_to<Camera3D>(ObjectDB::get_instance(camera_id));
+    }
+
+    Engine *engine = Engine::get_singleton();
+    SceneTree *tree = Object::cast_to<SceneTree>(engine->get_main_loop());
+    if (tree == nullptr || tree->get_root() == nullptr)
+    {
+        return nullptr;
+    }
+    return tree->get_root()->get_camera_3d();
+}
+
+float CurveMeshScheduler::_get_priority(const CurveMesh *p_mesh,
+                                        const Camera3D *p_camera,
+                                        const TypedArray<Plane> &p_frustum,
+                                        bool &r_hidden) const
+{
+    r_hidden = false;
+    if (p_camera == nullptr)
+    {
+        return 0.0f;
+    }
+
+    // Without a node in the tree there is nothing to measure. Such meshes
+    // are ranked with the hidden ones, in queue order.
+    const uint64_t *node_id = mesh_nodes.getptr(p_mesh->get_instance_id());
+    const Node3D *node =
+        node_id != nullptr
+            ? Object::cast_to<Node3D>(ObjectDB::get_instance(*node_id))
+            : nullptr;
+    if (node == nullptr || !node->is_inside_tree())
+    {
+        r_hidden = true;
+        return 0.0f;
+    }
+
+    const AABB bounds =
+        node->get_global_transform().xform(p_mesh->get_generated_aabb());
+    r_hidden = !node->is_visible_in_tree() || !_is_in_frustum(bounds,
+                                                              p_frustum);
+    return p_camera->get_global_position().distance_to(bounds.get_center());
+}
+
+void CurveMeshScheduler::_find_mesh_nodes(
+    const LocalVector<CurveMesh *> &p_meshes)
+{
+    // Only meshes without a live node are looked for, and each only once
+    // until a node enters the tree, so the tree is walked once per change
+    // at most.
+    HashSet<uint64_t> wanted;
+    for (const CurveMesh *mesh : p_meshes)
+    {
+        const uint64_t mesh_id = mesh->get_instance_id();
+        if (!mesh_nodes.has(mesh_id) && !searched_meshes.has(mesh_id))
+        {
+            wanted.insert(mesh_id);
+            searched_meshes.insert(mesh_id);
+        }
+    }
+    if (wanted.is_empty())
+    {
+        return;
+    }
+
+    Engine *engine = Engine::get_singleton();
+    SceneTree *tree = Object::cast_to<SceneTree>(engine->get_main_loop());
+    if (tree == nullptr || tree->get_root() == nullptr)
+    {
+        return;
+    }
+
+    LocalVector<Node *> stack;
+    stack.push_back(tree->get_root());
+    while (!stack.is_empty())
+    {
+        Node *node = stack[stack.size() - 1];
+        stack.resize(stack.size() - 1);
+        for (int i = 0; i < node->get_child_count(); i++)
+        {
+            stack.push_back(node->get_child(i));
+        }
+
+        MeshInstance3D *instance = Object::cast_to<MeshInstance3D>(node);
+        if (instance == nullptr || instance->get_mesh().is_null())
+        {
+            continue;
+        }
+        const uint64_t mesh_id = instance->get_mesh()->get_instance_id();
+        if (wanted.has(mesh_id))
+        {
+            mesh_nodes[mesh_id] = instance->get_instance_id();
+            wanted.erase(mesh_id);
+        }
+    }
+}
+
+void CurveMeshScheduler::_on_node_added(Node *p_node)
+{
+    if (Object::cast_to<MeshInstance3D>(p_node) != nullptr)
+    {
+        searched_meshes.clear();
+    }
+}
+
+void CurveMeshScheduler::_prune_mesh_nodes()
+{
+    LocalVector<uint64_t> freed;
+    for (const KeyValue<uint64_t, uint64_t> &entry : mesh_nodes)
+    {
+        if (ObjectDB::get_instance(entry.key) == nullptr ||
+            ObjectDB::get_instance(entry.value) == nullptr)
+        {
+            freed.push_back(entry.key);
+        }
+    }
+    for (uint64_t mesh_id : freed)
+    {
+        mesh_nodes.erase(mesh_id);
+    }
+}
+
+int CurveMeshScheduler::_find_job(const CurveMesh *p_mesh) const
+{
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        if (jobs[slot].mesh.ptr() == p_mesh)
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+int CurveMeshScheduler::_find_free_slot() const
+{
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        if (jobs[slot].mesh.is_null())
+        {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+void CurveMeshScheduler::_dispatch(int p_slot, CurveMesh *p_mesh,
+                                   bool p_hidden, float p_distance)
+{
+    Job &job = jobs[p_slot];
+    job.mesh = Ref<CurveMesh>(p_mesh);
+    job.hidden = p_hidden;
+    job.distance = p_distance;
+    queued_meshes.erase(p_mesh->get_instance_id());
+
+    // The snapshot reads the Curve3D, so it has to be taken here on the
+    // main thread.
+    p_mesh->prepare_build(job.build);
+    job.task = WorkerThreadPool::get_singleton()->add_task(
+        callable_mp(this, &CurveMeshScheduler::_run_job).bind(p_slot), false,
+        "CurveMesh build");
+}
+
+void CurveMeshScheduler::_commit(int p_slot)
+{
+    Job &job = jobs[p_slot];
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(job.task);
+    job.task = -1;
+
+    Ref<CurveMesh> mesh = job.mesh;
+    job.mesh.unref();
+    if (mesh->commit_build(job.build))
+    {
+        // Fetching the RID runs the pending surface update right away, so
+        // the upload is paid for inside the frame budget.
+        mesh->get_rid();
+    }
+    job.build = CurveMesh::BackgroundBuild();
+}
+
+void CurveMeshScheduler::_run_job(int p_slot)
+{
+    Job &job = jobs[p_slot];
+    job.mesh->run_build(job.build);
+}
+
+void CurveMeshScheduler::_process_frame()
+{
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    Time *time = Time::get_singleton();
+    const uint64_t begin_usec = time->get_ticks_usec();
+    const uint64_t budget_usec =
+        (uint64_t)(Math::max(frame_budget, 0.0f) * 1000.0f);
+
+    // Commit finished builds, most urgent first. At least one build is
+    // committed and one dispatched per frame, so a tiny budget still makes
+    // progress.
+    LocalVector<ScheduleEntry> finished;
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        const Job &job = jobs[slot];
+        if (job.task >= 0 && pool->is_task_completed(job.task))
+        {
+            ScheduleEntry entry;
+            entry.hidden = job.hidden;
+            entry.distance = job.distance;
+            entry.index = slot;
+            finished.push_back(entry);
+        }
+    }
+    finished.sort();
+
+    for (uint32_t i = 0; i < finished.size(); i++)
+    {
+        if (i > 0 && time->get_ticks_usec() - begin_usec >= budget_usec)
+        {
+            break;
+        }
+        _commit(finished[i].index);
+    }
+
+    // The queue holds IDs rather than references, so it does not keep
+    // meshes alive; freed ones are dropped here.
+    LocalVector<CurveMesh *> meshes;
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < queue.size(); i++)
+    {
+        CurveMesh *mesh =
+            Object::cast_to<CurveMesh>(ObjectDB::get_instance(queue[i]));
+        if (mesh != nullptr)
+        {
+            queue[live++] = queue[i];
+            meshes.push_back(mesh);
+        }
+        else
+        {
+            queued_meshes.erase(queue[i]);
+        }
+    }
+    queue.resize(live);
+    if (queue.is_empty())
+    {
+        return;
+    }
+
+    // Registrations are never removed when the mesh or its node is freed,
+    // so they are dropped here before they pile up.
+    _prune_mesh_nodes();
+    _find_mesh_nodes(meshes);
+
+    const Camera3D *camera = _get_camera();
+    TypedArray<Plane> frustum;
+    if (camera != nullptr)
+    {
+        frustum = camera->get_frustum();
+    }
+
+    LocalVector<ScheduleEntry> order;
+    order.resize(queue.size());
+    for (uint32_t i = 0; i < queue.size(); i++)
+    {
+        order[i].distance =
+            _get_priority(meshes[i], camera, frustum, order[i].hidden);
+        order[i].index = i;
+    }
+    order.sort();
+
+    // Meshes whose previous build is still running stay queued; the result
+    // of that build is outdated and is dropped when it is committed.
+    LocalVector<uint8_t> dispatched;
+    dispatched.resize(queue.size());
+    for (uint32_t i = 0; i < queue.size(); i++)
+    {
+        dispatched[i] = 0;
+    }
+
+    int dispatch_count = 0;
+    for (const ScheduleEntry &entry : order)
+    {
+        CurveMesh *mesh = meshes[entry.index];
+        if (_find_job(mesh) >= 0)
+        {
+            continue;
+        }
+        if (dispatch_count > 0 &&
+            time->get_ticks_usec() - begin_usec >= budget_usec)
+        {
+            break;
+        }
+        const int slot = _find_free_slot();
+        if (slot < 0)
+        {
+            break;
+        }
+        _dispatch(slot, mesh, entry.hidden, entry.distance);
+        dispatched[entry.index] = 1;
+        dispatch_count++;
+    }
+
+    uint32_t write = 0;
+    for (uint32_t i = 0; i < queue.size(); i++)
+    {
+        if (!dispatched[i])
+        {
+            queue[write++] = queue[i];
+        }
+    }
+    queue.resize(write);
+}
+
+bool CurveMeshScheduler::queue_mesh(CurveMesh *p_mesh)
+{
+    ERR_FAIL_NULL_V(p_mesh, false);
+    if (!_connect_to_tree())
+    {
+        return false;
+    }
+
+    const uint64_t mesh_id = p_mesh->get_instance_id();
+    if (!queued_meshes.has(mesh_id))
+    {
+        queued_meshes.insert(mesh_id);
+        queue.push_back(mesh_id);
+    }
+    return true;
+}
+
+void CurveMeshScheduler::wait_for_mesh(CurveMesh *p_mesh)
+{
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        Job &job = jobs[slot];
+        if (job.mesh.ptr() != p_mesh || job.task < 0)
+        {
+            continue;
+        }
+
+        // The caller is about to change data the build reads, so its
+        // result is dropped; the change queues the mesh again.
+        WorkerThreadPool::get_singleton()->wait_for_task_completion(job.task);
+        job.task = -1;
+        job.build = CurveMesh::BackgroundBuild();
+        job.mesh.unref();
+    }
+}
+
+void CurveMeshScheduler::flush()
+{
+    while (true)
+    {
+        bool busy = false;
+        for (int slot = 0; slot < MAX_JOBS; slot++)
+        {
+            if (jobs[slot].task >= 0)
+            {
+                _commit(slot);
+                busy = true;
+            }
+        }
+
+        uint32_t write = 0;
+        for (uint32_t i = 0; i < queue.size(); i++)
+        {
+            CurveMesh *mesh =
+                Object::cast_to<CurveMesh>(ObjectDB::get_instance(queue[i]));
+            if (mesh == nullptr)
+            {
+                queued_meshes.erase(queue[i]);
+                continue;
+            }
+            const int slot = _find_free_slot();
+            if (slot < 0)
+            {
+                queue[write++] = queue[i];
+                continue;
+            }
+            _dispatch(slot, mesh, false, 0.0f);
+            busy = true;
+        }
+        queue.resize(write);
+
+        if (!busy)
+        {
+            break;
+        }
+    }
+}
+
+void CurveMeshScheduler::set_mesh_node(const Ref<CurveMesh> &p_mesh,
+                                       Node3D *p_node)
+{
+    ERR_FAIL_COND(p_mesh.is_null());
+    if (p_node == nullptr)
+    {
+        mesh_nodes.erase(p_mesh->get_instance_id());
+        searched_meshes.erase(p_mesh->get_instance_id());
+        return;
+    }
+    mesh_nodes[p_mesh->get_instance_id()] = p_node->get_instance_id();
+}
+
+Node3D *CurveMeshScheduler::get_mesh_node(const Ref<CurveMesh> &p_mesh) const
+{
+    ERR_FAIL_COND_V(p_mesh.is_null(), nullptr);
+    const uint64_t *node_id = mesh_nodes.getptr(p_mesh->get_instance_id());
+    if (node_id == nullptr)
+    {
+        return nullptr;
+    }
+    return Object::cast_to<Node3D>(ObjectDB::get_instance(*node_id));
+}
+
+void CurveMeshScheduler::set_camera(Camera3D *p_camera)
+{
+    camera_id = p_camera != nullptr ? p_camera->get_instance_id() : 0;
+}
+
+Camera3D *CurveMeshScheduler::get_camera() const
+{
+    if (camera_id == 0)
+    {
+        return nullptr;
+    }
+    return Object::cast_to<Camera3D>(ObjectDB::get_instance(camera_id));
+}
+
+void CurveMeshScheduler::set_frame_budget(float p_budget)
+{
+    frame_budget = Math::max(p_budget, 0.0f);
+}
+
+float CurveMeshScheduler::get_frame_budget() const { return frame_budget; }
+
+int CurveMeshScheduler::get_pending_count() const
+{
+    int count = queue.size();
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        count += jobs[slot].mesh.is_valid();
+    }
+    return count;
+}
+
+void CurveMeshScheduler::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("queue_mesh", "mesh"),
+                         &CurveMeshScheduler::queue_mesh);
+    ClassDB::bind_method(D_METHOD("flush"), &CurveMeshScheduler::flush);
+
+    ClassDB::bind_method(D_METHOD("set_mesh_node", "mesh", "node"),
+                         &CurveMeshScheduler::set_mesh_node);
+    ClassDB::bind_method(D_METHOD("get_mesh_node", "mesh"),
+                         &CurveMeshScheduler::get_mesh_node);
+
+    ClassDB::bind_method(D_METHOD("set_camera", "camera"),
+                         &CurveMeshScheduler::set_camera);
+    ClassDB::bind_method(D_METHOD("get_camera"),
+                         &CurveMeshScheduler::get_camera);
+
+    ClassDB::bind_method(D_METHOD("set_frame_budget", "budget"),
+                         &CurveMeshScheduler::set_frame_budget);
+    ClassDB::bind_method(D_METHOD("get_frame_budget"),
+                         &CurveMeshScheduler::get_frame_budget);
+
+    ClassDB::bind_method(D_METHOD("get_pending_count"),
+                         &CurveMeshScheduler::get_pending_count);
+
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "frame_budget",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,16.0,0.1,or_greater,suffix:ms"),
+                 "set_frame_budget", "get_frame_budget");
+}
+
+} // namespace godot
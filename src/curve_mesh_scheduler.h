@@ -0,0 +1,99 @@
+#ifndef CURVE_MESH_SCHEDULER_H
+#define CURVE_MESH_SCHEDULER_H
+
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/camera3d.hpp>
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/classes/object.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/plane.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+namespace godot
+{
+
+// Rebuilds CurveMeshes with use_scheduler enabled on the WorkerThreadPool.
+// Queued meshes are snapshotted and finished builds are committed once per
+// frame, most urgent first, for as long as the frame budget allows; the
+// rest waits for the next frame.
+class CurveMeshScheduler : public Object
+{
+    GDCLASS(CurveMeshScheduler, Object);
+
+  public:
+    static constexpr int MAX_JOBS = 64;
+
+  private:
+    struct Job
+    {
+        Ref<CurveMesh> mesh;
+        CurveMesh::BackgroundBuild build;
+        int64_t task = -1;
+        bool hidden = false;
+        float distance = 0.0f;
+    };
+
+    static CurveMeshScheduler *singleton;
+
+    // Jobs live in fixed slots so a worker can be handed its slot index
+    // while the main thread keeps filling other slots.
+    Job jobs[MAX_JOBS];
+    LocalVector<uint64_t> queue;
+    HashSet<uint64_t> queued_meshes;
+    HashMap<uint64_t, uint64_t> mesh_nodes;
+    // Meshes already looked for since a MeshInstance3D last entered the
+    // tree.
+    HashSet<uint64_t> searched_meshes;
+    uint64_t camera_id = 0;
+    float frame_budget = 2.0f;
+    bool connected = false;
+
+  private:
+    bool _connect_to_tree();
+    Camera3D *_get_camera() const;
+    float _get_priority(const CurveMesh *p_mesh, const Camera3D *p_camera,
+                        const TypedArray<Plane> &p_frustum,
+                        bool &r_hidden) const;
+    void _find_mesh_nodes(const LocalVector<CurveMesh *> &p_meshes);
+    void _on_node_added(Node *p_node);
+    void _prune_mesh_nodes();
+    int _find_job(const CurveMesh *p_mesh) const;
+    int _find_free_slot() const;
+    void _dispatch(int p_slot, CurveMesh *p_mesh, bool p_hidden,
+                   float p_distance);
+    void _commit(int p_slot);
+    void _run_job(int p_slot);
+    void _process_frame();
+
+  protected:
+    static void _bind_methods();
+
+  public:
+    static CurveMeshScheduler *get_singleton();
+
+    bool queue_mesh(CurveMesh *p_mesh);
+    void wait_for_mesh(CurveMesh *p_mesh);
+    void flush();
+
+    void set_mesh_node(const Ref<CurveMesh> &p_mesh, Node3D *p_node);
+    Node3D *get_mesh_node(const Ref<CurveMesh> &p_mesh) const;
+
+    void set_camera(Camera3D *p_camera);
+    Camera3D *get_camera() const;
+
+    void set_frame_budget(float p_budget);
+    float get_frame_budget() const;
+
+    int get_pending_count() const;
+
+    CurveMeshScheduler();
+    ~CurveMeshScheduler();
+};
+
+} // namespace godot
+
+#endif // CURVE_MESH_SCHEDULER_H
@@ -0,0 +1,919 @@
+#include "curve_mesh_streamer.h"
+
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/viewport.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/packed_color_array.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector2_array.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace godot
+{
+
+namespace
+{
+// Ordering key of a span, nearest first.
+struct StreamEntry
+{
+    float distance = 0.0f;
+    int index = 0;
+
+    bool operator<(const StreamEntry &p_other) const
+    {
+        return distance < p_other.distance;
+    }
+};
+
+static float _get_distance_to_aabb(const AABB &p_aabb, const Vector3 &p_point)
+{
+    const Vector3 end = p_aabb.position + p_aabb.size;
+    const Vector3 closest(CLAMP(p_point.x, p_aabb.position.x, end.x),
+                          CLAMP(p_point.y, p_aabb.position.y, end.y),
+                          CLAMP(p_point.z, p_aabb.position.z, end.z));
+    return p_point.distance_to(closest);
+}
+
+static int64_t _get_arrays_memory(const Array &p_arrays)
+{
+    int64_t bytes = 0;
+    for (int64_t i = 0; i < p_arrays.size(); i++)
+    {
+        const Variant &array = p_arrays[i];
+        switch (array.get_type())
+        {
+        case Variant::PACKED_VECTOR3_ARRAY:
+            bytes += PackedVector3Array(array).size() * sizeof(Vector3);
+            break;
+        case Variant::PACKED_VECTOR2_ARRAY:
+            bytes += PackedVector2Array(array).size() * sizeof(Vector2);
+            break;
+        case Variant::PACKED_FLOAT32_ARRAY:
+            bytes += PackedFloat32Array(array).size() * sizeof(float);
+            break;
+        case Variant::PACKED_INT32_ARRAY:
+            bytes += PackedInt32Array(array).size() * sizeof(int32_t);
+            break;
+        case Variant::PACKED_BYTE_ARRAY:
+            bytes += PackedByteArray(array).size();
+            break;
+        case Variant::PACKED_COLOR_ARRAY:
+            bytes += PackedColorArray(array).size() * sizeof(Color);
+            break;
+        default:
+            break;
+        }
+    }
+    return bytes;
+}
+
+static void _append_points(CurveDataFile::Points &r_points,
+                           const CurveDataFile::Points &p_points)
+{
+    r_points.positions.append_array(p_points.positions);
+    r_points.in_handles.append_array(p_points.in_handles);
+    r_points.out_handles.append_array(p_points.out_handles);
+    r_points.tilts.append_array(p_points.tilts);
+    r_points.widths.append_array(p_points.widths);
+}
+} // namespace
+
+CurveMeshStreamer::CurveMeshStreamer() { set_mesh(memnew(CurveMesh)); }
+
+CurveMeshStreamer::~CurveMeshStreamer() { _cancel_jobs(); }
+
+void CurveMeshStreamer::_notification(int p_what)
+{
+    switch (p_what)
+    {
+    case NOTIFICATION_ENTER_TREE:
+        has_target_position = false;
+        set_process_internal(true);
+        break;
+    case NOTIFICATION_EXIT_TREE:
+        set_process_internal(false);
+        _cancel_jobs();
+        break;
+    case NOTIFICATION_INTERNAL_PROCESS:
+        _process_streaming(get_process_delta_time());
+        break;
+    default:
+        break;
+    }
+}
+
+void CurveMeshStreamer::_update_spans()
+{
+    _cancel_jobs();
+    _clear_spans();
+    spans_dirty = false;
+    baked_points.clear();
+    baked_tilts.clear();
+    source_point_count = 0;
+    source_length = 0.0f;
+    source_closed = false;
+    source_handles = false;
+
+    if (curve_data.is_valid() && curve_data->is_open())
+    {
+        // The file index already has everything the spans need, so no
+        // point data is read here.
+        source_point_count = curve_data->get_point_count();
+        source_length = curve_data->get_length();
+        source_closed = curve_data->is_closed();
+        source_handles = curve_data->has_handles();
+        spans.resize(curve_data->get_chunk_count());
+        for (uint32_t i = 0; i < spans.size(); i++)
+        {
+            const Vector2i range = curve_data->get_chunk_range(i);
+            spans[i].begin = range.x;
+            spans[i].count = range.y;
+            spans[i].distance = curve_data->get_chunk_distance(i);
+            spans[i].bounds = curve_data->get_chunk_aabb(i);
+        }
+        // A last chunk of one point has no segment of its own; building
+        // it would only repeat the end of the chunk before it.
+        const int last = (int)spans.size() - 1;
+        if (last > 0 && spans[last].count == 1)
+        {
+            spans[last - 1].count++;
+            spans[last - 1].bounds.merge_with(spans[last].bounds);
+            spans.resize(last);
+        }
+    }
+    else if (curve.is_valid() && curve->get_point_count() > 1)
+    {
+        baked_points = curve->get_baked_points();
+        baked_tilts = curve->get_baked_tilts();
+        source_closed = curve->is_closed();
+        int64_t point_count = baked_points.size();
+        if (source_closed && point_count > 1)
+        {
+            // The last baked point of a closed curve repeats the first.
+            point_count--;
+            baked_points.resize(point_count);
+        }
+        if (baked_tilts.size() < point_count)
+        {
+            baked_tilts.clear();
+        }
+        else
+        {
+            baked_tilts.resize(point_count);
+        }
+
+        source_point_count = point_count;
+        const Vector3 *points = baked_points.ptr();
+        int64_t span_count =
+            (point_count + span_point_count - 1) / span_point_count;
+        if (span_count > 1 && point_count % span_point_count == 1)
+        {
+            // A single point left over has no segment of its own, so it
+            // goes to the span before it.
+            span_count--;
+        }
+        spans.resize(span_count);
+        double distance = 0.0;
+        for (int64_t s = 0; s < span_count; s++)
+        {
+            Span &span = spans[s];
+            span.begin = s * span_point_count;
+            span.count = (s + 1 < span_count) ? span_point_count
+                                              : point_count - span.begin;
+            if (s > 0)
+            {
+                distance += points[span.begin].distance_to(
+                    points[span.begin - 1]);
+            }
+            span.distance = distance;
+            span.bounds = AABB(points[span.begin], Vector3());
+            for (int64_t i = span.begin + 1; i < span.begin + span.count; i++)
+            {
+                distance += points[i].distance_to(points[i - 1]);
+                span.bounds.expand_to(points[i]);
+            }
+        }
+        if (source_closed && point_count > 1)
+        {
+            distance += points[0].distance_to(points[point_count - 1]);
+        }
+        source_length = distance;
+    }
+
+    if (source_point_count < 2)
+    {
+        spans.clear();
+        source_point_count = 0;
+    }
+    // Wrapping around needs a point on either side of the seam.
+    source_closed = source_closed && source_point_count >= 3;
+}
+
+void CurveMeshStreamer::_clear_spans()
+{
+    for (uint32_t i = 0; i < spans.size(); i++)
+    {
+        _unload_span(i);
+    }
+    spans.clear();
+    memory_usage = 0;
+}
+
+bool CurveMeshStreamer::_read_points(int64_t p_begin, int64_t p_count,
+                                     CurveDataFile::Points &r_points)
+{
+    r_points = CurveDataFile::Points();
+    int64_t index = p_begin;
+    if (source_closed)
+    {
+        index = Math::posmod(p_begin, source_point_count);
+    }
+    ERR_FAIL_COND_V(index < 0 || index >= source_point_count, false);
+
+    // A closed curve is read in two pieces where the range wraps around.
+    int64_t remaining = p_count;
+    while (remaining > 0)
+    {
+        const int64_t count = Math::min(remaining, source_point_count - index);
+        ERR_FAIL_COND_V(count <= 0, false);
+
+        CurveDataFile::Points points;
+        if (!baked_points.is_empty())
+        {
+            points.positions = baked_points.slice(index, index + count);
+            if (!baked_tilts.is_empty())
+            {
+                points.tilts = baked_tilts.slice(index, index + count);
+            }
+        }
+        else if (!curve_data->read_range(index, count, points))
+        {
+            return false;
+        }
+        _append_points(r_points, points);
+
+        remaining -= count;
+        index = 0;
+    }
+    return true;
+}
+
+bool CurveMeshStreamer::_get_target_positions(double p_delta,
+                                              Vector3 &r_position,
+                                              Vector3 &r_predicted)
+{
+    Node3D *node = nullptr;
+    if (!target.is_empty())
+    {
+        node = Object::cast_to<Node3D>(get_node_or_null(target));
+    }
+    else if (get_viewport() != nullptr)
+    {
+        node = get_viewport()->get_camera_3d();
+    }
+    if (node == nullptr)
+    {
+        has_target_position = false;
+        return false;
+    }
+
+    // Spans are in the local space of the streamer.
+    r_position = get_global_transform().affine_inverse().xform(
+        node->get_global_position());
+    if (has_target_position && p_delta > 0.0)
+    {
+        // Smoothed, so one uneven frame does not throw the prediction off.
+        const Vector3 velocity =
+            (r_position - last_target_position) / (real_t)p_delta;
+        target_velocity = target_velocity.lerp(velocity, 0.25f);
+    }
+    else
+    {
+        target_velocity = Vector3();
+    }
+    last_target_position = r_position;
+    has_target_position = true;
+
+    r_predicted = r_position + target_velocity * lookahead_time;
+    return true;
+}
+
+float CurveMeshStreamer::_get_span_margin() const
+{
+    // Spans are measured from their center points, so they are grown by
+    // how far the surface may reach out from the centerline.
+    const Ref<Curve> width_curve = mesh->get_width_curve();
+    float max_width_sample = 1.0f;
+    if (width_curve.is_valid())
+    {
+        max_width_sample = Math::max(width_curve->get_max_value(),
+                                     -width_curve->get_min_value());
+    }
+    return Math::abs(mesh->get_width()) * max_width_sample *
+           mesh->get_profile_extent();
+}
+
+bool CurveMeshStreamer::_dispatch(int p_slot, int p_span)
+{
+    Job &job = jobs[p_slot];
+    Span &span = spans[p_span];
+
+    // Besides its own points, a span reads the first point of the next
+    // span to close the gap between them, and one more point on either
+    // side to orient its end rings the same way as its neighbours do.
+    const int64_t end = span.begin + span.count;
+    job.lead = source_closed || span.begin > 0;
+    int64_t last = end - 1;
+    if (source_closed || end < source_point_count)
+    {
+        last++;
+    }
+    job.trail = source_closed || last + 1 < source_point_count;
+    if (job.trail)
+    {
+        last++;
+    }
+    const int64_t first = span.begin - (job.lead ? 1 : 0);
+    if (!_read_points(first, last - first + 1, job.points))
+    {
+        job.points = CurveDataFile::Points();
+        return false;
+    }
+
+    CurveMesh::BackgroundBuild &build = job.build;
+    build = CurveMesh::BackgroundBuild();
+    // The worker only reads this copy of the settings, never the mesh.
+    build.settings = mesh->get_build_settings();
+    build.settings.tessellation_mode = CurveMesh::TESSELLATION_DISABLED;
+    // Overlap filtering and decimation only see one span, so they would
+    // trim or drop the points at a seam differently on either side of it.
+    build.settings.filter_overlaps = false;
+    build.settings.filter_distant_overlaps = false;
+    build.settings.decimation_tolerance = 0.0f;
+    if (source_length > 0.0f)
+    {
+        const float span_end = (p_span + 1 < (int)spans.size())
+                                   ? spans[p_span + 1].distance
+                                   : source_length;
+        build.settings.span_begin = span.distance / source_length;
+        build.settings.span_end = span_end / source_length;
+        build.settings.span_length = source_length;
+    }
+    build.snapshot.lead_context = job.lead;
+    build.snapshot.trail_context = job.trail;
+
+    if (!source_handles)
+    {
+        build.snapshot.point_positions = job.points.positions;
+        build.snapshot.point_tilts = job.points.tilts;
+        build.snapshot.point_widths = job.points.widths;
+        build.snapshot.point_count = job.points.positions.size();
+        job.points = CurveDataFile::Points();
+    }
+
+    job.span = p_span;
+    job.serial = ++build_serial;
+    span.job = p_slot;
+    span.job_serial = job.serial;
+    job.task = WorkerThreadPool::get_singleton()->add_task(
+        callable_mp(this, &CurveMeshStreamer::_run_job).bind(p_slot), false,
+        "CurveMeshStreamer span");
+    return true;
+}
+
+void CurveMeshStreamer::_run_job(int p_slot)
+{
+    Job &job = jobs[p_slot];
+    if (!job.points.positions.is_empty())
+    {
+        _tessellate_job(job);
+    }
+    mesh->run_build(job.build);
+}
+
+void CurveMeshStreamer::_tessellate_job(Job &r_job) const
+{
+    const CurveDataFile::Points &points = r_job.points;
+    const int count = points.positions.size();
+    const float tolerance = r_job.build.settings.tessellation_tolerance;
+
+    auto tessellate = [&](int p_from, int p_to)
+    {
+        CurveMesh::CurveSnapshot snapshot;
+        for (int i = p_from; i <= p_to; i++)
+        {
+            snapshot.positions.push_back(points.positions[i]);
+            snapshot.in_handles.push_back(points.in_handles[i]);
+            snapshot.out_handles.push_back(points.out_handles[i]);
+        }
+        return mesh->tessellate_snapshot(snapshot, tolerance);
+    };
+
+    // The context points become the tessellated points next to the span
+    // ends, which the neighbouring spans produce the same way.
+    PackedVector3Array positions;
+    const int body_begin = r_job.lead ? 1 : 0;
+    const int body_end = r_job.trail ? count - 2 : count - 1;
+    if (r_job.lead)
+    {
+        const PackedVector3Array lead = tessellate(0, 1);
+        positions.push_back(lead[lead.size() - 2]);
+    }
+    positions.append_array(tessellate(body_begin, body_end));
+    if (r_job.trail)
+    {
+        positions.push_back(tessellate(count - 2, count - 1)[1]);
+    }
+
+    r_job.build.snapshot.point_positions = positions;
+    r_job.build.snapshot.point_count = positions.size();
+    r_job.points = CurveDataFile::Points();
+}
+
+void CurveMeshStreamer::_commit(int p_slot)
+{
+    Job &job = jobs[p_slot];
+    WorkerThreadPool::get_singleton()->wait_for_task_completion(job.task);
+    job.task = -1;
+
+    const int span_index = job.span;
+    const uint32_t serial = job.serial;
+    const CurveMesh::BackgroundBuild build = job.build;
+    job = Job();
+
+    // A span that was unloaded, or rebuilt from scratch, while the job ran
+    // no longer wants this result.
+    if (span_index < 0 || span_index >= (int)spans.size())
+    {
+        return;
+    }
+    Span &span = spans[span_index];
+    if (span.job == p_slot)
+    {
+        span.job = -1;
+    }
+    if (span.job_serial != serial)
+    {
+        return;
+    }
+    span.job_serial = 0;
+
+    Ref<ArrayMesh> array_mesh;
+    array_mesh.instantiate();
+    if (build.stats.triangle_count > 0)
+    {
+        array_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES,
+                                            build.arrays);
+        if (mesh->get_material().is_valid())
+        {
+            array_mesh->surface_set_material(0, mesh->get_material());
+        }
+    }
+
+    if (span.instance == nullptr)
+    {
+        span.instance = memnew(MeshInstance3D);
+        add_child(span.instance, false, INTERNAL_MODE_BACK);
+    }
+    span.instance->set_mesh(array_mesh);
+
+    const int64_t memory = _get_arrays_memory(build.arrays);
+    memory_usage += memory - span.memory;
+    span.memory = memory;
+    span.stale = false;
+}
+
+void CurveMeshStreamer::_cancel_jobs()
+{
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        Job &job = jobs[slot];
+        if (job.task >= 0)
+        {
+            pool->wait_for_task_completion(job.task);
+            job.task = -1;
+        }
+        if (job.span >= 0 && job.span < (int)spans.size())
+        {
+            spans[job.span].job = -1;
+            spans[job.span].job_serial = 0;
+        }
+        job = Job();
+    }
+}
+
+void CurveMeshStreamer::_unload_span(int p_span)
+{
+    Span &span = spans[p_span];
+    if (span.instance != nullptr)
+    {
+        span.instance->queue_free();
+        span.instance = nullptr;
+    }
+    memory_usage -= span.memory;
+    span.memory = 0;
+    span.stale = false;
+    span.job_serial = 0;
+}
+
+void CurveMeshStreamer::_process_streaming(double p_delta)
+{
+    if (spans_dirty)
+    {
+        _update_spans();
+    }
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        if (jobs[slot].task >= 0 && pool->is_task_completed(jobs[slot].task))
+        {
+            _commit(slot);
+        }
+    }
+
+    Vector3 position;
+    Vector3 predicted;
+    if (spans.is_empty() || mesh.is_null() ||
+        !_get_target_positions(p_delta, position, predicted))
+    {
+        return;
+    }
+
+    // Spans are wanted within stream_radius of where the target is or will
+    // soon be, and kept until they are unload_margin further away.
+    const float margin = _get_span_margin();
+    LocalVector<StreamEntry> shown;
+    LocalVector<StreamEntry> wanted;
+    int64_t shown_points = 0;
+    for (uint32_t i = 0; i < spans.size(); i++)
+    {
+        Span &span = spans[i];
+        const AABB bounds = span.bounds.grow(margin);
+        StreamEntry entry;
+        entry.distance = Math::min(_get_distance_to_aabb(bounds, position),
+                                   _get_distance_to_aabb(bounds, predicted));
+        entry.index = i;
+
+        if (span.instance != nullptr &&
+            entry.distance > stream_radius + unload_margin)
+        {
+            _unload_span(i);
+        }
+        else if (span.instance != nullptr)
+        {
+            shown.push_back(entry);
+            shown_points += span.count;
+        }
+
+        if (entry.distance <= stream_radius && span.job < 0 &&
+            (span.instance == nullptr || span.stale))
+        {
+            wanted.push_back(entry);
+        }
+    }
+    shown.sort();
+    wanted.sort();
+
+    // Over the cap, the farthest spans go first. The nearest one always
+    // stays, so the target never ends up with nothing around it.
+    const int64_t cap = (int64_t)(max_memory * 1024.0f * 1024.0f);
+    while (memory_usage > cap && shown.size() > 1)
+    {
+        const StreamEntry farthest = shown[shown.size() - 1];
+        shown.resize(shown.size() - 1);
+        shown_points -= spans[farthest.index].count;
+        _unload_span(farthest.index);
+    }
+
+    // New spans are sized from the spans shown so far, and only started
+    // while they fit under the cap, possibly by dropping farther ones.
+    const double bytes_per_point =
+        (shown_points > 0) ? (double)memory_usage / shown_points : 0.0;
+    int64_t expected = memory_usage;
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        const Job &job = jobs[slot];
+        if (job.task >= 0 && spans[job.span].instance == nullptr)
+        {
+            expected += (int64_t)(bytes_per_point * spans[job.span].count);
+        }
+    }
+
+    int slot = 0;
+    for (const StreamEntry &entry : wanted)
+    {
+        while (slot < MAX_JOBS && jobs[slot].task >= 0)
+        {
+            slot++;
+        }
+        if (slot >= MAX_JOBS)
+        {
+            break;
+        }
+
+        Span &span = spans[entry.index];
+        const int64_t estimate =
+            (span.instance == nullptr)
+                ? (int64_t)(bytes_per_point * span.count)
+                : 0;
+        while (expected + estimate > cap && !shown.is_empty() &&
+               shown[shown.size() - 1].distance > entry.distance)
+        {
+            const int farthest = shown[shown.size() - 1].index;
+            shown.resize(shown.size() - 1);
+            expected -= spans[farthest].memory;
+            _unload_span(farthest);
+        }
+        if (expected + estimate > cap && !shown.is_empty())
+        {
+            break;
+        }
+
+        // A span whose points cannot be read leaves the slot to the next.
+        if (_dispatch(slot, entry.index))
+        {
+            expected += estimate;
+            slot++;
+        }
+    }
+}
+
+void CurveMeshStreamer::_on_source_changed() { spans_dirty = true; }
+
+void CurveMeshStreamer::_on_mesh_changed()
+{
+    // Shown spans stay up until their rebuild with the new settings is
+    // ready.
+    _cancel_jobs();
+    for (Span &span : spans)
+    {
+        span.stale = span.instance != nullptr;
+    }
+}
+
+void CurveMeshStreamer::set_mesh(const Ref<CurveMesh> &p_mesh)
+{
+    if (mesh == p_mesh)
+    {
+        return;
+    }
+
+    _cancel_jobs();
+    const Callable callable =
+        callable_mp(this, &CurveMeshStreamer::_on_mesh_changed);
+    if (mesh.is_valid())
+    {
+        mesh->disconnect("changed", callable);
+    }
+
+    mesh = p_mesh;
+
+    if (mesh.is_valid())
+    {
+        mesh->connect("changed", callable);
+    }
+    _on_mesh_changed();
+}
+
+Ref<CurveMesh> CurveMeshStreamer::get_mesh() const { return mesh; }
+
+void CurveMeshStreamer::set_curve(const Ref<Curve3D> &p_curve)
+{
+    if (curve == p_curve)
+    {
+        return;
+    }
+
+    const Callable callable =
+        callable_mp(this, &CurveMeshStreamer::_on_source_changed);
+    if (curve.is_valid())
+    {
+        curve->disconnect("changed", callable);
+    }
+
+    curve = p_curve;
+
+    if (curve.is_valid())
+    {
+        curve->connect("changed", callable);
+    }
+    spans_dirty = true;
+}
+
+Ref<Curve3D> CurveMeshStreamer::get_curve() const { return curve; }
+
+void CurveMeshStreamer::set_curve_data(const Ref<CurveDataFile> &p_data)
+{
+    if (curve_data == p_data)
+    {
+        return;
+    }
+
+    const Callable callable =
+        callable_mp(this, &CurveMeshStreamer::_on_source_changed);
+    if (curve_data.is_valid())
+    {
+        curve_data->disconnect("changed", callable);
+    }
+
+    curve_data = p_data;
+
+    if (curve_data.is_valid())
+    {
+        curve_data->connect("changed", callable);
+    }
+    spans_dirty = true;
+}
+
+Ref<CurveDataFile> CurveMeshStreamer::get_curve_data() const
+{
+    return curve_data;
+}
+
+void CurveMeshStreamer::set_target(const NodePath &p_path)
+{
+    target = p_path;
+    has_target_position = false;
+}
+
+NodePath CurveMeshStreamer::get_target() const { return target; }
+
+void CurveMeshStreamer::set_stream_radius(float p_radius)
+{
+    stream_radius = Math::max(p_radius, 0.0f);
+}
+
+float CurveMeshStreamer::get_stream_radius() const { return stream_radius; }
+
+void CurveMeshStreamer::set_unload_margin(float p_margin)
+{
+    unload_margin = Math::max(p_margin, 0.0f);
+}
+
+float CurveMeshStreamer::get_unload_margin() const { return unload_margin; }
+
+void CurveMeshStreamer::set_lookahead_time(float p_time)
+{
+    lookahead_time = Math::max(p_time, 0.0f);
+}
+
+float CurveMeshStreamer::get_lookahead_time() const { return lookahead_time; }
+
+void CurveMeshStreamer::set_max_memory(float p_megabytes)
+{
+    max_memory = Math::max(p_megabytes, 0.0f);
+}
+
+float CurveMeshStreamer::get_max_memory() const { return max_memory; }
+
+void CurveMeshStreamer::set_span_point_count(int p_count)
+{
+    p_count = Math::max(p_count, 2);
+    if (span_point_count != p_count)
+    {
+        span_point_count = p_count;
+        spans_dirty = true;
+    }
+}
+
+int CurveMeshStreamer::get_span_point_count() const
+{
+    return span_point_count;
+}
+
+int CurveMeshStreamer::get_span_count()
+{
+    if (spans_dirty)
+    {
+        _update_spans();
+    }
+    return spans.size();
+}
+
+int CurveMeshStreamer::get_loaded_span_count() const
+{
+    int count = 0;
+    for (const Span &span : spans)
+    {
+        count += span.instance != nullptr;
+    }
+    return count;
+}
+
+int CurveMeshStreamer::get_pending_count() const
+{
+    int count = 0;
+    for (int slot = 0; slot < MAX_JOBS; slot++)
+    {
+        count += jobs[slot].task >= 0;
+    }
+    return count;
+}
+
+int64_t CurveMeshStreamer::get_memory_usage() const { return memory_usage; }
+
+bool CurveMeshStreamer::is_span_loaded(int p_span) const
+{
+    ERR_FAIL_INDEX_V(p_span, (int)spans.size(), false);
+    return spans[p_span].instance != nullptr;
+}
+
+void CurveMeshStreamer::reload() { spans_dirty = true; }
+
+void CurveMeshStreamer::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("set_mesh", "mesh"),
+                         &CurveMeshStreamer::set_mesh);
+    ClassDB::bind_method(D_METHOD("get_mesh"), &CurveMeshStreamer::get_mesh);
+
+    ClassDB::bind_method(D_METHOD("set_curve", "curve"),
+                         &CurveMeshStreamer::set_curve);
+    ClassDB::bind_method(D_METHOD("get_curve"), &CurveMeshStreamer::get_curve);
+
+    ClassDB::bind_method(D_METHOD("set_curve_data", "data"),
+                         &CurveMeshStreamer::set_curve_data);
+    ClassDB::bind_method(D_METHOD("get_curve_data"),
+                         &CurveMeshStreamer::get_curve_data);
+
+    ClassDB::bind_method(D_METHOD("set_target", "path"),
+                         &CurveMeshStreamer::set_target);
+    ClassDB::bind_method(D_METHOD("get_target"),
+                         &CurveMeshStreamer::get_target);
+
+    ClassDB::bind_method(D_METHOD("set_stream_radius", "radius"),
+                         &CurveMeshStreamer::set_stream_radius);
+    ClassDB::bind_method(D_METHOD("get_stream_radius"),
+                         &CurveMeshStreamer::get_stream_radius);
+
+    ClassDB::bind_method(D_METHOD("set_unload_margin", "margin"),
+                         &CurveMeshStreamer::set_unload_margin);
+    ClassDB::bind_method(D_METHOD("get_unload_margin"),
+                         &CurveMeshStreamer::get_unload_margin);
+
+    ClassDB::bind_method(D_METHOD("set_lookahead_time", "time"),
+                         &CurveMeshStreamer::set_lookahead_time);
+    ClassDB::bind_method(D_METHOD("get_lookahead_time"),
+                         &CurveMeshStreamer::get_lookahead_time);
+
+    ClassDB::bind_method(D_METHOD("set_max_memory", "megabytes"),
+                         &CurveMeshStreamer::set_max_memory);
+    ClassDB::bind_method(D_METHOD("get_max_memory"),
+                         &CurveMeshStreamer::get_max_memory);
+
+    ClassDB::bind_method(D_METHOD("set_span_point_count", "count"),
+                         &CurveMeshStreamer::set_span_point_count);
+    ClassDB::bind_method(D_METHOD("get_span_point_count"),
+                         &CurveMeshStreamer::get_span_point_count);
+
+    ClassDB::bind_method(D_METHOD("get_span_count"),
+                         &CurveMeshStreamer::get_span_count);
+    ClassDB::bind_method(D_METHOD("get_loaded_span_count"),
+                         &CurveMeshStreamer::get_loaded_span_count);
+    ClassDB::bind_method(D_METHOD("get_pending_count"),
+                         &CurveMeshStreamer::get_pending_count);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"),
+                         &CurveMeshStreamer::get_memory_usage);
+    ClassDB::bind_method(D_METHOD("is_span_loaded", "span"),
+                         &CurveMeshStreamer::is_span_loaded);
+    ClassDB::bind_method(D_METHOD("reload"), &CurveMeshStreamer::reload);
+
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mesh",
+                              PROPERTY_HINT_RESOURCE_TYPE, "CurveMesh"),
+                 "set_mesh", "get_mesh");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve",
+                              PROPERTY_HINT_RESOURCE_TYPE, "Curve3D"),
+                 "set_curve", "get_curve");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "curve_data",
+                              PROPERTY_HINT_RESOURCE_TYPE, "CurveDataFile"),
+                 "set_curve_data", "get_curve_data");
+    ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "target",
+                              PROPERTY_HINT_NODE_PATH_VALID_TYPES, "Node3D"),
+                 "set_target", "get_target");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "stream_radius",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,1000.0,0.1,or_greater,suffix:m"),
+                 "set_stream_radius", "get_stream_radius");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "unload_margin",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,100.0,0.1,or_greater,suffix:m"),
+                 "set_unload_margin", "get_unload_margin");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lookahead_time",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,5.0,0.01,or_greater,suffix:s"),
+                 "set_lookahead_time", "get_lookahead_time");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_memory",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,1024.0,1.0,or_greater,suffix:MiB"),
+                 "set_max_memory", "get_max_memory");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "span_point_count",
+                              PROPERTY_HINT_RANGE, "2,4096,1,or_greater"),
+                 "set_span_point_count", "get_span_point_count");
+}
+
+} // namespace godot
@@ -0,0 +1,160 @@
+#ifndef CURVE_MESH_STREAMER_H
+#define CURVE_MESH_STREAMER_H
+
+#include "curve_data_file.h"
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/curve3d.hpp>
+#include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/node3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/node_path.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+namespace godot
+{
+
+// Shows a very long curve only around a target node. The curve is split
+// into spans, the chunks of a CurveDataFile or runs of baked points of a
+// Curve3D. Spans near the target, or near where it is heading, are built on
+// the WorkerThreadPool with the settings of a template CurveMesh and shown
+// as internal MeshInstance3D children. Spans out of range, and the farthest
+// ones once the memory cap is reached, are dropped again.
+class CurveMeshStreamer : public Node3D
+{
+    GDCLASS(CurveMeshStreamer, Node3D);
+
+  public:
+    static constexpr int MAX_JOBS = 8;
+
+  private:
+    struct Span
+    {
+        int64_t begin = 0;
+        int count = 0;
+        float distance = 0.0f;
+        AABB bounds;
+        MeshInstance3D *instance = nullptr;
+        int64_t memory = 0;
+        int job = -1;
+        // Serial of the job whose result the span still wants. Unloading
+        // clears it, so a build that finishes afterwards is dropped.
+        uint32_t job_serial = 0;
+        // Shown, but built with settings that have changed since.
+        bool stale = false;
+    };
+
+    // Points of a span are read on the main thread. Control points with
+    // handles are tessellated on the worker, then the span is built from
+    // the resulting center points.
+    struct Job
+    {
+        int span = -1;
+        int64_t task = -1;
+        uint32_t serial = 0;
+        CurveDataFile::Points points;
+        bool lead = false;
+        bool trail = false;
+        CurveMesh::BackgroundBuild build;
+    };
+
+    Ref<CurveMesh> mesh;
+    Ref<Curve3D> curve;
+    Ref<CurveDataFile> curve_data;
+    NodePath target;
+    float stream_radius = 200.0f;
+    float unload_margin = 20.0f;
+    float lookahead_time = 1.0f;
+    float max_memory = 64.0f;
+    int span_point_count = 256;
+
+    // Whole curve as the spans see it. Baked points are only kept for a
+    // Curve3D source; a file is read span by span.
+    PackedVector3Array baked_points;
+    PackedFloat32Array baked_tilts;
+    LocalVector<Span> spans;
+    int64_t source_point_count = 0;
+    float source_length = 0.0f;
+    bool source_closed = false;
+    bool source_handles = false;
+    bool spans_dirty = true;
+
+    Job jobs[MAX_JOBS];
+    uint32_t build_serial = 0;
+    int64_t memory_usage = 0;
+
+    Vector3 last_target_position;
+    Vector3 target_velocity;
+    bool has_target_position = false;
+
+  private:
+    void _update_spans();
+    void _clear_spans();
+    bool _read_points(int64_t p_begin, int64_t p_count,
+                      CurveDataFile::Points &r_points);
+    bool _get_target_positions(double p_delta, Vector3 &r_position,
+                               Vector3 &r_predicted);
+    float _get_span_margin() const;
+
+    bool _dispatch(int p_slot, int p_span);
+    void _run_job(int p_slot);
+    void _tessellate_job(Job &r_job) const;
+    void _commit(int p_slot);
+    void _cancel_jobs();
+    void _unload_span(int p_span);
+    void _process_streaming(double p_delta);
+
+    void _on_source_changed();
+    void _on_mesh_changed();
+
+  protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+  public:
+    void set_mesh(const Ref<CurveMesh> &p_mesh);
+    Ref<CurveMesh> get_mesh() const;
+
+    void set_curve(const Ref<Curve3D> &p_curve);
+    Ref<Curve3D> get_curve() const;
+
+    void set_curve_data(const Ref<CurveDataFile> &p_data);
+    Ref<CurveDataFile> get_curve_data() const;
+
+    void set_target(const NodePath &p_path);
+    NodePath get_target() const;
+
+    void set_stream_radius(float p_radius);
+    float get_stream_radius() const;
+
+    void set_unload_margin(float p_margin);
+    float get_unload_margin() const;
+
+    void set_lookahead_time(float p_time);
+    float get_lookahead_time() const;
+
+    void set_max_memory(float p_megabytes);
+    float get_max_memory() const;
+
+    void set_span_point_count(int p_count);
+    int get_span_point_count() const;
+
+    int get_span_count();
+    int get_loaded_span_count() const;
+    int get_pending_count() const;
+    int64_t get_memory_usage() const;
+    bool is_span_loaded(int p_span) const;
+
+    void reload();
+
+    CurveMeshStreamer();
+    ~CurveMeshStreamer();
+};
+
+} // namespace godot
+
+#endif // CURVE_MESH_STREAMER_H
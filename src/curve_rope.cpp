@@ -0,0 +1,495 @@
+#include "curve_rope.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/physics_direct_space_state3d.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/callable_method_pointer.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+
+namespace godot
+{
+
+namespace
+{
+// Substeps run per physics frame at most, so a long hitch does not stall
+// the next frames catching up.
+constexpr int MAX_STEPS_PER_FRAME = 4;
+} // namespace
+
+LocalVector<CurveRope *> CurveRope::ropes;
+uint64_t CurveRope::solved_frame = UINT64_MAX;
+
+CurveRope::CurveRope() {}
+
+CurveRope::~CurveRope() { ropes.erase(this); }
+
+void CurveRope::_notification(int p_what)
+{
+    switch (p_what)
+    {
+    case NOTIFICATION_ENTER_TREE:
+        reset();
+        if (!Engine::get_singleton()->is_editor_hint())
+        {
+            ropes.push_back(this);
+            set_physics_process_internal(true);
+        }
+        break;
+    case NOTIFICATION_EXIT_TREE:
+        ropes.erase(this);
+        set_physics_process_internal(false);
+        break;
+    case NOTIFICATION_INTERNAL_PHYSICS_PROCESS:
+    {
+        // Whichever rope is processed first in a physics frame solves all
+        // of them; each rope then collides and uploads its own result.
+        const uint64_t frame = Engine::get_singleton()->get_physics_frames();
+        if (solved_frame != frame)
+        {
+            solved_frame = frame;
+            _solve_ropes(get_physics_process_delta_time());
+        }
+        if (!stepped)
+        {
+            break;
+        }
+        if (collide)
+        {
+            _apply_collisions();
+        }
+        _update_mesh();
+        stepped = false;
+    }
+    break;
+    default:
+        break;
+    }
+}
+
+void CurveRope::_solve_ropes(double p_delta)
+{
+    // Anchors are node transforms, so they are read here on the main thread
+    // before the workers start.
+    for (CurveRope *rope : ropes)
+    {
+        rope->_prepare_step(p_delta);
+    }
+
+    if (ropes.size() == 1)
+    {
+        ropes[0]->_solve();
+        return;
+    }
+
+    WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+    const int64_t task = pool->add_group_task(
+        callable_mp_static(&CurveRope::_solve_rope_at), ropes.size(), -1,
+        true, "CurveRope solve");
+    pool->wait_for_group_task_completion(task);
+}
+
+void CurveRope::_solve_rope_at(uint32_t p_index) { ropes[p_index]->_solve(); }
+
+void CurveRope::_prepare_step(double p_delta)
+{
+    pending_steps = 0;
+    if (!can_process() || positions.size() < 2)
+    {
+        return;
+    }
+
+    _update_anchors();
+    frame_positions = positions;
+
+    time_accumulator += (float)p_delta;
+    const float step = Math::max(time_step, 0.001f);
+    while (time_accumulator >= step && pending_steps < MAX_STEPS_PER_FRAME)
+    {
+        time_accumulator -= step;
+        pending_steps++;
+    }
+    if (pending_steps == MAX_STEPS_PER_FRAME)
+    {
+        time_accumulator = 0.0f;
+    }
+}
+
+bool CurveRope::_is_pinned(int p_index) const
+{
+    return (p_index == 0 && pin_start) ||
+           (p_index == (int)positions.size() - 1 && end_pinned);
+}
+
+void CurveRope::_solve()
+{
+    const int count = positions.size();
+    if (count < 2 || pending_steps == 0)
+    {
+        return;
+    }
+
+    const float dt = Math::max(time_step, 0.001f);
+    const Vector3 acceleration = gravity * dt * dt;
+    const float keep = 1.0f - Math::clamp(damping, 0.0f, 1.0f);
+    const float segment_length = length / (count - 1);
+
+    for (int step = 0; step < pending_steps; step++)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (_is_pinned(i))
+            {
+                positions[i] = (i == 0) ? start_position : end_position;
+                previous_positions[i] = positions[i];
+                continue;
+            }
+            const Vector3 velocity =
+                (positions[i] - previous_positions[i]) * keep;
+            previous_positions[i] = positions[i];
+            positions[i] += velocity + acceleration;
+        }
+
+        for (int iteration = 0; iteration < iterations; iteration++)
+        {
+            for (int i = 0; i + 1 < count; i++)
+            {
+                const Vector3 delta = positions[i + 1] - positions[i];
+                const float distance = delta.length();
+                if (distance <= CMP_EPSILON)
+                {
+                    continue;
+                }
+
+                const float weight_a = _is_pinned(i) ? 0.0f : 1.0f;
+                const float weight_b = _is_pinned(i + 1) ? 0.0f : 1.0f;
+                const float weight_sum = weight_a + weight_b;
+                if (weight_sum == 0.0f)
+                {
+                    continue;
+                }
+
+                const Vector3 correction =
+                    delta * ((distance - segment_length) / distance);
+                positions[i] += correction * (weight_a / weight_sum);
+                positions[i + 1] -= correction * (weight_b / weight_sum);
+            }
+        }
+    }
+
+    pending_steps = 0;
+    stepped = true;
+}
+
+void CurveRope::_apply_collisions()
+{
+    if (!is_inside_tree() || frame_positions.size() != positions.size())
+    {
+        return;
+    }
+
+    Ref<World3D> world = get_world_3d();
+    if (world.is_null())
+    {
+        return;
+    }
+    PhysicsDirectSpaceState3D *space = world->get_direct_space_state();
+    if (space == nullptr)
+    {
+        return;
+    }
+
+    if (ray_query.is_null())
+    {
+        ray_query.instantiate();
+    }
+    ray_query->set_collision_mask(collision_mask);
+
+    // Each point is traced from where it started the frame to where the
+    // solver moved it, and stopped at the first surface on the way.
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        if (_is_pinned(i) || frame_positions[i] == positions[i])
+        {
+            continue;
+        }
+        ray_query->set_from(frame_positions[i]);
+        ray_query->set_to(positions[i]);
+        const Dictionary hit = space->intersect_ray(ray_query);
+        if (hit.is_empty())
+        {
+            continue;
+        }
+        const Vector3 hit_position = hit["position"];
+        const Vector3 hit_normal = hit["normal"];
+        positions[i] = hit_position + hit_normal * collision_radius;
+        previous_positions[i] = positions[i];
+    }
+}
+
+void CurveRope::_update_mesh()
+{
+    // Pushing points would switch the mesh over from its curve for good,
+    // and save them with the scene, so the editor keeps showing the curve.
+    if (Engine::get_singleton()->is_editor_hint())
+    {
+        return;
+    }
+
+    Ref<CurveMesh> curve_mesh = get_mesh();
+    if (curve_mesh.is_null() || positions.size() < 2)
+    {
+        return;
+    }
+
+    const Transform3D to_local = get_global_transform().affine_inverse();
+    local_points.resize(positions.size());
+    Vector3 *points = local_points.ptrw();
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        points[i] = to_local.xform(positions[i]);
+    }
+    curve_mesh->set_points(local_points);
+}
+
+void CurveRope::_update_anchors()
+{
+    start_position = get_global_position();
+    end_pinned = false;
+    if (end_anchor.is_empty())
+    {
+        return;
+    }
+
+    const Node3D *anchor =
+        Object::cast_to<Node3D>(get_node_or_null(end_anchor));
+    if (anchor != nullptr)
+    {
+        end_pinned = true;
+        end_position = anchor->get_global_position();
+    }
+}
+
+void CurveRope::reset()
+{
+    if (!is_inside_tree())
+    {
+        return;
+    }
+
+    const int count = Math::max(point_count, 2);
+    positions.resize(count);
+    _update_anchors();
+
+    // Start from the shape of the mesh's curve when there is one, otherwise
+    // hang straight down along the gravity.
+    Ref<CurveMesh> curve_mesh = get_mesh();
+    Ref<Curve3D> curve;
+    if (curve_mesh.is_valid())
+    {
+        curve = curve_mesh->get_curve();
+    }
+
+    if (curve.is_valid() && curve->get_point_count() > 1)
+    {
+        const Transform3D to_global = get_global_transform();
+        const float baked_length = curve->get_baked_length();
+        for (int i = 0; i < count; i++)
+        {
+            const float offset = baked_length * i / (count - 1);
+            positions[i] = to_global.xform(curve->sample_baked(offset));
+        }
+    }
+    else
+    {
+        Vector3 direction = gravity.normalized();
+        if (direction.is_zero_approx())
+        {
+            direction = Vector3(0.0f, -1.0f, 0.0f);
+        }
+        for (int i = 0; i < count; i++)
+        {
+            positions[i] =
+                start_position + direction * (length * i / (count - 1));
+        }
+    }
+
+    previous_positions = positions;
+    frame_positions = positions;
+    time_accumulator = 0.0f;
+    pending_steps = 0;
+    _update_mesh();
+}
+
+PackedVector3Array CurveRope::get_simulated_points() const
+{
+    PackedVector3Array points;
+    points.resize(positions.size());
+    for (uint32_t i = 0; i < positions.size(); i++)
+    {
+        points.set(i, positions[i]);
+    }
+    return points;
+}
+
+void CurveRope::set_point_count(int p_count)
+{
+    int clamped = Math::max(p_count, 2);
+    if (point_count != clamped)
+    {
+        point_count = clamped;
+        reset();
+    }
+}
+
+int CurveRope::get_point_count() const { return point_count; }
+
+void CurveRope::set_length(float p_length)
+{
+    length = Math::max(p_length, 0.001f);
+}
+
+float CurveRope::get_length() const { return length; }
+
+void CurveRope::set_gravity(const Vector3 &p_gravity) { gravity = p_gravity; }
+
+Vector3 CurveRope::get_gravity() const { return gravity; }
+
+void CurveRope::set_damping(float p_damping)
+{
+    damping = Math::clamp(p_damping, 0.0f, 1.0f);
+}
+
+float CurveRope::get_damping() const { return damping; }
+
+void CurveRope::set_iterations(int p_iterations)
+{
+    iterations = Math::max(p_iterations, 1);
+}
+
+int CurveRope::get_iterations() const { return iterations; }
+
+void CurveRope::set_time_step(float p_time_step)
+{
+    time_step = Math::max(p_time_step, 0.001f);
+}
+
+float CurveRope::get_time_step() const { return time_step; }
+
+void CurveRope::set_pin_start(bool p_enable) { pin_start = p_enable; }
+
+bool CurveRope::is_pin_start() const { return pin_start; }
+
+void CurveRope::set_end_anchor(const NodePath &p_path) { end_anchor = p_path; }
+
+NodePath CurveRope::get_end_anchor() const { return end_anchor; }
+
+void CurveRope::set_collide(bool p_enable) { collide = p_enable; }
+
+bool CurveRope::is_collide() const { return collide; }
+
+void CurveRope::set_collision_mask(uint32_t p_mask) { collision_mask = p_mask; }
+
+uint32_t CurveRope::get_collision_mask() const { return collision_mask; }
+
+void CurveRope::set_collision_radius(float p_radius)
+{
+    collision_radius = Math::max(p_radius, 0.0f);
+}
+
+float CurveRope::get_collision_radius() const { return collision_radius; }
+
+void CurveRope::_bind_methods()
+{
+    ClassDB::bind_method(D_METHOD("reset"), &CurveRope::reset);
+    ClassDB::bind_method(D_METHOD("get_simulated_points"),
+                         &CurveRope::get_simulated_points);
+
+    ClassDB::bind_method(D_METHOD("set_point_count", "count"),
+                         &CurveRope::set_point_count);
+    ClassDB::bind_method(D_METHOD("get_point_count"),
+                         &CurveRope::get_point_count);
+
+    ClassDB::bind_method(D_METHOD("set_length", "length"),
+                         &CurveRope::set_length);
+    ClassDB::bind_method(D_METHOD("get_length"), &CurveRope::get_length);
+
+    ClassDB::bind_method(D_METHOD("set_gravity", "gravity"),
+                         &CurveRope::set_gravity);
+    ClassDB::bind_method(D_METHOD("get_gravity"), &CurveRope::get_gravity);
+
+    ClassDB::bind_method(D_METHOD("set_damping", "damping"),
+                         &CurveRope::set_damping);
+    ClassDB::bind_method(D_METHOD("get_damping"), &CurveRope::get_damping);
+
+    ClassDB::bind_method(D_METHOD("set_iterations", "iterations"),
+                         &CurveRope::set_iterations);
+    ClassDB::bind_method(D_METHOD("get_iterations"),
+                         &CurveRope::get_iterations);
+
+    ClassDB::bind_method(D_METHOD("set_time_step", "time_step"),
+                         &CurveRope::set_time_step);
+    ClassDB::bind_method(D_METHOD("get_time_step"), &CurveRope::get_time_step);
+
+    ClassDB::bind_method(D_METHOD("set_pin_start", "enable"),
+                         &CurveRope::set_pin_start);
+    ClassDB::bind_method(D_METHOD("is_pin_start"), &CurveRope::is_pin_start);
+
+    ClassDB::bind_method(D_METHOD("set_end_anchor", "path"),
+                         &CurveRope::set_end_anchor);
+    ClassDB::bind_method(D_METHOD("get_end_anchor"),
+                         &CurveRope::get_end_anchor);
+
+    ClassDB::bind_method(D_METHOD("set_collide", "enable"),
+                         &CurveRope::set_collide);
+    ClassDB::bind_method(D_METHOD("is_collide"), &CurveRope::is_collide);
+
+    ClassDB::bind_method(D_METHOD("set_collision_mask", "mask"),
+                         &CurveRope::set_collision_mask);
+    ClassDB::bind_method(D_METHOD("get_collision_mask"),
+                         &CurveRope::get_collision_mask);
+
+    ClassDB::bind_method(D_METHOD("set_collision_radius", "radius"),
+                         &CurveRope::set_collision_radius);
+    ClassDB::bind_method(D_METHOD("get_collision_radius"),
+                         &CurveRope::get_collision_radius);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "point_count", PROPERTY_HINT_RANGE,
+                              "2,128,1,or_greater"),
+                 "set_point_count", "get_point_count");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "length", PROPERTY_HINT_RANGE,
+                              "0.001,100.0,0.01,or_greater,suffix:m"),
+                 "set_length", "get_length");
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "pin_start"), "set_pin_start",
+                 "is_pin_start");
+    ADD_PROPERTY(PropertyInfo(Variant::NODE_PATH, "end_anchor",
+                              PROPERTY_HINT_NODE_PATH_VALID_TYPES, "Node3D"),
+                 "set_end_anchor", "get_end_anchor");
+
+    ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "gravity"), "set_gravity",
+                 "get_gravity");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "damping", PROPERTY_HINT_RANGE,
+                              "0.0,1.0,0.001"),
+                 "set_damping", "get_damping");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "iterations", PROPERTY_HINT_RANGE,
+                              "1,64,1,or_greater"),
+                 "set_iterations", "get_iterations");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "time_step", PROPERTY_HINT_RANGE,
+                              "0.001,0.1,0.001,suffix:s"),
+                 "set_time_step", "get_time_step");
+
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "collide"), "set_collide",
+                 "is_collide");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask",
+                              PROPERTY_HINT_LAYERS_3D_PHYSICS),
+                 "set_collision_mask", "get_collision_mask");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "collision_radius",
+                              PROPERTY_HINT_RANGE,
+                              "0.0,1.0,0.001,or_greater,suffix:m"),
+                 "set_collision_radius", "get_collision_radius");
+}
+
+} // namespace godot
@@ -0,0 +1,114 @@
+#ifndef CURVE_ROPE_H
+#define CURVE_ROPE_H
+
+#include "curve_mesh.h"
+
+#include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/classes/physics_ray_query_parameters3d.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/node_path.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+namespace godot
+{
+
+// Verlet rope that drives the CurveMesh assigned as its mesh. The simulated
+// points are handed to the mesh directly as center points, without going
+// through a Curve3D. All ropes in the scene are stepped together on the
+// WorkerThreadPool once per physics frame.
+class CurveRope : public MeshInstance3D
+{
+    GDCLASS(CurveRope, MeshInstance3D);
+
+  private:
+    int point_count = 16;
+    float length = 2.0f;
+    Vector3 gravity = Vector3(0.0f, -9.8f, 0.0f);
+    float damping = 0.02f;
+    int iterations = 8;
+    float time_step = 1.0f / 60.0f;
+    bool pin_start = true;
+    NodePath end_anchor;
+
+    bool collide = false;
+    uint32_t collision_mask = 1;
+    float collision_radius = 0.05f;
+
+    // Simulation state, in global space.
+    LocalVector<Vector3> positions;
+    LocalVector<Vector3> previous_positions;
+    LocalVector<Vector3> frame_positions;
+    PackedVector3Array local_points;
+    Vector3 start_position;
+    Vector3 end_position;
+    bool end_pinned = false;
+    float time_accumulator = 0.0f;
+    int pending_steps = 0;
+    bool stepped = false;
+    Ref<PhysicsRayQueryParameters3D> ray_query;
+
+    static LocalVector<CurveRope *> ropes;
+    static uint64_t solved_frame;
+
+  private:
+    static void _solve_ropes(double p_delta);
+    static void _solve_rope_at(uint32_t p_index);
+
+    void _prepare_step(double p_delta);
+    void _solve();
+    void _apply_collisions();
+    void _update_mesh();
+    void _update_anchors();
+    bool _is_pinned(int p_index) const;
+
+  protected:
+    static void _bind_methods();
+    void _notification(int p_what);
+
+  public:
+    void reset();
+
+    void set_point_count(int p_count);
+    int get_point_count() const;
+
+    void set_length(float p_length);
+    float get_length() const;
+
+    void set_gravity(const Vector3 &p_gravity);
+    Vector3 get_gravity() const;
+
+    void set_damping(float p_damping);
+    float get_damping() const;
+
+    void set_iterations(int p_iterations);
+    int get_iterations() const;
+
+    void set_time_step(float p_time_step);
+    float get_time_step() const;
+
+    void set_pin_start(bool p_enable);
+    bool is_pin_start() const;
+
+    void set_end_anchor(const NodePath &p_path);
+    NodePath get_end_anchor() const;
+
+    void set_collide(bool p_enable);
+    bool is_collide() const;
+
+    void set_collision_mask(uint32_t p_mask);
+    uint32_t get_collision_mask() const;
+
+    void set_collision_radius(float p_radius);
+    float get_collision_radius() const;
+
+    PackedVector3Array get_simulated_points() const;
+
+    CurveRope();
+    ~CurveRope();
+};
+
+} // namespace godot
+
+#endif // CURVE_ROPE_H
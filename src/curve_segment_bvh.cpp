@@ -0,0 +1,438 @@
+#include "curve_segment_bvh.h"
+
+#include <godot_cpp/core/math.hpp>
+
+namespace godot
+{
+
+namespace
+{
+static constexpr float NO_HIT = 1e20f;
+
+static float _get_box_distance_squared(const Vector3 &p_point,
+                                       const Vector3 &p_min,
+                                       const Vector3 &p_max)
+{
+    float distance_squared = 0.0f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float outside = 0.0f;
+        if (p_point[axis] < p_min[axis])
+        {
+            outside = p_min[axis] - p_point[axis];
+        }
+        else if (p_point[axis] > p_max[axis])
+        {
+            outside = p_point[axis] - p_max[axis];
+        }
+        distance_squared += outside * outside;
+    }
+    return distance_squared;
+}
+
+// Entry distance of a ray into a box, or NO_HIT. p_inverse_direction holds
+// the reciprocal of each direction component.
+static float _intersect_box(const Vector3 &p_from,
+                            const Vector3 &p_inverse_direction,
+                            const Vector3 &p_min, const Vector3 &p_max)
+{
+    float near = 0.0f;
+    float far = NO_HIT;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float t0 = (p_min[axis] - p_from[axis]) * p_inverse_direction[axis];
+        float t1 = (p_max[axis] - p_from[axis]) * p_inverse_direction[axis];
+        if (t0 > t1)
+        {
+            const float swap = t0;
+            t0 = t1;
+            t1 = swap;
+        }
+        near = Math::max(near, t0);
+        far = Math::min(far, t1);
+        if (near > far)
+        {
+            return NO_HIT;
+        }
+    }
+    return near;
+}
+
+// Exact signed distance to a round cone, after Inigo Quilez.
+static float _get_round_cone_distance(const Vector3 &p_point,
+                                      const Vector3 &p_a, const Vector3 &p_b,
+                                      float p_radius_a, float p_radius_b)
+{
+    const Vector3 ba = p_b - p_a;
+    const float l2 = ba.dot(ba);
+    const float rr = p_radius_a - p_radius_b;
+    const float a2 = l2 - rr * rr;
+    if (a2 <= 0.0f)
+    {
+        // One end sphere contains the other.
+        return p_radius_a > p_radius_b
+                   ? p_point.distance_to(p_a) - p_radius_a
+                   : p_point.distance_to(p_b) - p_radius_b;
+    }
+
+    const float il2 = 1.0f / l2;
+    const Vector3 pa = p_point - p_a;
+    const float y = pa.dot(ba);
+    const float z = y - l2;
+    const Vector3 side = pa * l2 - ba * y;
+    const float x2 = side.dot(side);
+    const float y2 = y * y * l2;
+    const float z2 = z * z * l2;
+
+    const float k = (rr < 0.0f ? -1.0f : 1.0f) * rr * rr * x2;
+    if ((z < 0.0f ? -1.0f : 1.0f) * a2 * z2 > k)
+    {
+        return Math::sqrt(x2 + z2) * il2 - p_radius_b;
+    }
+    if ((y < 0.0f ? -1.0f : 1.0f) * a2 * y2 < k)
+    {
+        return Math::sqrt(x2 + y2) * il2 - p_radius_a;
+    }
+    return (Math::sqrt(x2 * a2 * il2) + y * rr) * il2 - p_radius_a;
+}
+
+static float _intersect_sphere(const Vector3 &p_from,
+                               const Vector3 &p_direction,
+                               const Vector3 &p_center, float p_radius)
+{
+    const Vector3 oc = p_from - p_center;
+    const float b = oc.dot(p_direction);
+    const float h = b * b - oc.dot(oc) + p_radius * p_radius;
+    if (h < 0.0f)
+    {
+        return NO_HIT;
+    }
+    const float t = -b - Math::sqrt(h);
+    return t >= 0.0f ? t : NO_HIT;
+}
+
+// Distance along a normalized ray to a round cone, after Inigo Quilez, or
+// NO_HIT. Rays starting inside the cone do not hit it.
+static float _intersect_round_cone(const Vector3 &p_from,
+                                   const Vector3 &p_direction,
+                                   const Vector3 &p_a, const Vector3 &p_b,
+                                   float p_radius_a, float p_radius_b,
+                                   Vector3 &r_normal)
+{
+    const Vector3 ba = p_b - p_a;
+    const Vector3 oa = p_from - p_a;
+    const float rr = p_radius_a - p_radius_b;
+    const float m0 = ba.dot(ba);
+    const float d2 = m0 - rr * rr;
+    if (d2 <= 0.0f)
+    {
+        const Vector3 center = p_radius_a > p_radius_b ? p_a : p_b;
+        const float radius = Math::max(p_radius_a, p_radius_b);
+        const float t = _intersect_sphere(p_from, p_direction, center, radius);
+        if (t < NO_HIT)
+        {
+            r_normal = (p_from + p_direction * t - center).normalized();
+        }
+        return t;
+    }
+
+    const float m1 = ba.dot(oa);
+    const float m2 = ba.dot(p_direction);
+    const float m3 = p_direction.dot(oa);
+    const float m5 = oa.dot(oa);
+
+    // Cone body.
+    const float k2 = d2 - m2 * m2;
+    const float k1 = d2 * m3 - m1 * m2 + m2 * rr * p_radius_a;
+    const float k0 = d2 * m5 - m1 * m1 + m1 * rr * p_radius_a * 2.0f -
+                     m0 * p_radius_a * p_radius_a;
+    const float h = k1 * k1 - k0 * k2;
+    if (h < 0.0f)
+    {
+        return NO_HIT;
+    }
+    if (k2 != 0.0f)
+    {
+        const float t = (-Math::sqrt(h) - k1) / k2;
+        const float y = m1 - p_radius_a * rr + t * m2;
+        if (t >= 0.0f && y > 0.0f && y < d2)
+        {
+            r_normal = (oa * d2 + p_direction * (t * d2) - ba * y).normalized();
+            return t;
+        }
+    }
+
+    // End spheres.
+    float best = NO_HIT;
+    const float t_a = _intersect_sphere(p_from, p_direction, p_a, p_radius_a);
+    if (t_a < best)
+    {
+        best = t_a;
+        r_normal = (p_from + p_direction * t_a - p_a).normalized();
+    }
+    const float t_b = _intersect_sphere(p_from, p_direction, p_b, p_radius_b);
+    if (t_b < best)
+    {
+        best = t_b;
+        r_normal = (p_from + p_direction * t_b - p_b).normalized();
+    }
+    return best;
+}
+} // namespace
+
+void CurveSegmentBVH::clear()
+{
+    segments.clear();
+    nodes.clear();
+}
+
+void CurveSegmentBVH::add_segment(const Vector3 &p_from, const Vector3 &p_to,
+                                  float p_from_radius, float p_to_radius,
+                                  float p_from_offset, float p_to_offset)
+{
+    Segment segment;
+    segment.from = p_from;
+    segment.to = p_to;
+    segment.from_radius = Math::abs(p_from_radius);
+    segment.to_radius = Math::abs(p_to_radius);
+    segment.from_offset = p_from_offset;
+    segment.to_offset = p_to_offset;
+    segments.push_back(segment);
+}
+
+void CurveSegmentBVH::build()
+{
+    nodes.clear();
+    if (segments.is_empty())
+    {
+        return;
+    }
+    nodes.reserve(2 * segments.size() / LEAF_SIZE + 1);
+    _build_node(0, segments.size(), 0);
+}
+
+bool CurveSegmentBVH::is_empty() const { return nodes.is_empty(); }
+
+void CurveSegmentBVH::_build_node(uint32_t p_begin, uint32_t p_end,
+                                  int p_depth)
+{
+    const uint32_t index = nodes.size();
+    nodes.push_back(Node());
+
+    Vector3 min = segments[p_begin].from;
+    Vector3 max = min;
+    Vector3 center_min = (segments[p_begin].from + segments[p_begin].to) * 0.5f;
+    Vector3 center_max = center_min;
+    for (uint32_t i = p_begin; i < p_end; i++)
+    {
+        const Segment &segment = segments[i];
+        const Vector3 center = (segment.from + segment.to) * 0.5f;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            min[axis] = Math::min(
+                min[axis], Math::min(segment.from[axis] - segment.from_radius,
+                                     segment.to[axis] - segment.to_radius));
+            max[axis] = Math::max(
+                max[axis], Math::max(segment.from[axis] + segment.from_radius,
+                                     segment.to[axis] + segment.to_radius));
+            center_min[axis] = Math::min(center_min[axis], center[axis]);
+            center_max[axis] = Math::max(center_max[axis], center[axis]);
+        }
+    }
+    nodes[index].min = min;
+    nodes[index].max = max;
+
+    const uint32_t count = p_end - p_begin;
+    if (count <= (uint32_t)LEAF_SIZE || p_depth >= MAX_DEPTH - 1)
+    {
+        nodes[index].right_or_first = p_begin;
+        nodes[index].count = count;
+        return;
+    }
+
+    // Split at the middle of the longest axis of the segment centers. Curve
+    // segments are spread out evenly enough that this beats a full SAH
+    // build, which would cost more than the queries it saves.
+    const Vector3 extent = center_max - center_min;
+    int axis = 0;
+    if (extent.y > extent[axis])
+    {
+        axis = 1;
+    }
+    if (extent.z > extent[axis])
+    {
+        axis = 2;
+    }
+    const float split = (center_min[axis] + center_max[axis]) * 0.5f;
+
+    uint32_t middle = p_begin;
+    for (uint32_t i = p_begin; i < p_end; i++)
+    {
+        const Segment &segment = segments[i];
+        if ((segment.from[axis] + segment.to[axis]) * 0.5f < split)
+        {
+            const Segment swap = segments[middle];
+            segments[middle] = segments[i];
+            segments[i] = swap;
+            middle++;
+        }
+    }
+    if (middle == p_begin || middle == p_end)
+    {
+        // All centers coincide along the axis.
+        middle = p_begin + count / 2;
+    }
+
+    _build_node(p_begin, middle, p_depth + 1);
+    nodes[index].right_or_first = nodes.size();
+    _build_node(middle, p_end, p_depth + 1);
+}
+
+float CurveSegmentBVH::get_closest(const Vector3 &p_point,
+                                   float &r_offset) const
+{
+    float best = NO_HIT;
+    r_offset = 0.0f;
+    if (nodes.is_empty())
+    {
+        return best;
+    }
+
+    uint32_t stack[MAX_DEPTH + 1];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const uint32_t index = stack[--stack_size];
+        const Node &node = nodes[index];
+
+        // Outside a box, every cone inside it is at least as far as the box.
+        const float box_distance_squared =
+            _get_box_distance_squared(p_point, node.min, node.max);
+        if (best >= 0.0f && box_distance_squared > best * best)
+        {
+            continue;
+        }
+        if (best < 0.0f && box_distance_squared > 0.0f)
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                const Segment &segment = segments[node.right_or_first + i];
+                const float distance = _get_round_cone_distance(
+                    p_point, segment.from, segment.to, segment.from_radius,
+                    segment.to_radius);
+                if (distance >= best)
+                {
+                    continue;
+                }
+                best = distance;
+
+                const Vector3 direction = segment.to - segment.from;
+                const float length_squared = direction.length_squared();
+                const float t =
+                    length_squared > 0.0f
+                        ? Math::clamp((p_point - segment.from).dot(direction) /
+                                          length_squared,
+                                      0.0f, 1.0f)
+                        : 0.0f;
+                r_offset =
+                    Math::lerp(segment.from_offset, segment.to_offset, t);
+            }
+            continue;
+        }
+
+        // Visit the nearer child first so the farther one is more likely
+        // to be culled.
+        const uint32_t left = index + 1;
+        const uint32_t right = node.right_or_first;
+        const bool right_first =
+            _get_box_distance_squared(p_point, nodes[right].min,
+                                      nodes[right].max) <
+            _get_box_distance_squared(p_point, nodes[left].min,
+                                      nodes[left].max);
+        stack[stack_size++] = right_first ? left : right;
+        stack[stack_size++] = right_first ? right : left;
+    }
+    return best;
+}
+
+bool CurveSegmentBVH::intersect_ray(const Vector3 &p_from,
+                                    const Vector3 &p_direction,
+                                    float p_max_distance,
+                                    RayHit &r_hit) const
+{
+    if (nodes.is_empty())
+    {
+        return false;
+    }
+
+    Vector3 inverse_direction;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        inverse_direction[axis] = p_direction[axis] != 0.0f
+                                      ? 1.0f / p_direction[axis]
+                                      : NO_HIT;
+    }
+
+    // Misses come back as NO_HIT, which an infinite p_max_distance would
+    // still accept as a hit.
+    float best = Math::min(p_max_distance, NO_HIT);
+    bool hit = false;
+    uint32_t stack[MAX_DEPTH + 1];
+    int stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const uint32_t index = stack[--stack_size];
+        const Node &node = nodes[index];
+        if (_intersect_box(p_from, inverse_direction, node.min, node.max) >=
+            best)
+        {
+            continue;
+        }
+
+        if (node.count > 0)
+        {
+            for (uint32_t i = 0; i < node.count; i++)
+            {
+                const Segment &segment = segments[node.right_or_first + i];
+                Vector3 normal;
+                const float distance = _intersect_round_cone(
+                    p_from, p_direction, segment.from, segment.to,
+                    segment.from_radius, segment.to_radius, normal);
+                if (distance >= best)
+                {
+                    continue;
+                }
+                best = distance;
+                hit = true;
+
+                const Vector3 direction = segment.to - segment.from;
+                const float length_squared = direction.length_squared();
+                const Vector3 position = p_from + p_direction * distance;
+                const float t =
+                    length_squared > 0.0f
+                        ? Math::clamp((position - segment.from).dot(direction) /
+                                          length_squared,
+                                      0.0f, 1.0f)
+                        : 0.0f;
+                r_hit.distance = distance;
+                r_hit.normal = normal;
+                r_hit.offset =
+                    Math::lerp(segment.from_offset, segment.to_offset, t);
+            }
+            continue;
+        }
+
+        stack[stack_size++] = node.right_or_first;
+        stack[stack_size++] = index + 1;
+    }
+    return hit;
+}
+
+} // namespace godot
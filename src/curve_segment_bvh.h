@@ -0,0 +1,71 @@
+#ifndef CURVE_SEGMENT_BVH_H
+#define CURVE_SEGMENT_BVH_H
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+namespace godot
+{
+
+// Bounding volume hierarchy over the segments of a tessellated curve. Each
+// segment is swept into a round cone: a sphere at both ends, with the radius
+// of that end, joined by the cone tangent to both spheres.
+class CurveSegmentBVH
+{
+  public:
+    struct RayHit
+    {
+        float distance = 0.0f;
+        Vector3 normal;
+        float offset = 0.0f;
+    };
+
+    void clear();
+    void add_segment(const Vector3 &p_from, const Vector3 &p_to,
+                     float p_from_radius, float p_to_radius,
+                     float p_from_offset, float p_to_offset);
+    void build();
+    bool is_empty() const;
+
+    // Signed distance from p_point to the swept surface, negative inside.
+    // r_offset receives the curve offset of the closest segment.
+    float get_closest(const Vector3 &p_point, float &r_offset) const;
+
+    // p_direction must be normalized. Hits closer than p_max_distance only.
+    bool intersect_ray(const Vector3 &p_from, const Vector3 &p_direction,
+                       float p_max_distance, RayHit &r_hit) const;
+
+  private:
+    static constexpr int LEAF_SIZE = 4;
+    static constexpr int MAX_DEPTH = 64;
+
+    struct Segment
+    {
+        Vector3 from;
+        Vector3 to;
+        float from_radius = 0.0f;
+        float to_radius = 0.0f;
+        float from_offset = 0.0f;
+        float to_offset = 0.0f;
+    };
+
+    // Children of an inner node are stored depth first: the left child
+    // right after its parent, the right child at right_or_first. Leaves
+    // have a non-zero count and list segments from right_or_first on.
+    struct Node
+    {
+        Vector3 min;
+        Vector3 max;
+        uint32_t right_or_first = 0;
+        uint32_t count = 0;
+    };
+
+    LocalVector<Segment> segments;
+    LocalVector<Node> nodes;
+
+    void _build_node(uint32_t p_begin, uint32_t p_end, int p_depth);
+};
+
+} // namespace godot
+
+#endif // CURVE_SEGMENT_BVH_H
@@ -1,12 +1,20 @@
+#include "curve_data_file.h"
+#include "curve_graph_mesh.h"
 #include "curve_mesh.h"
+#include "curve_mesh_baker.h"
+#include "curve_mesh_exporter.h"
+#include "curve_mesh_profiler.h"
+#include "curve_mesh_scheduler.h"
+#include "curve_mesh_streamer.h"
+#include "curve_rope.h"
 
 #include <gdextension_interface.h>
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/godot.hpp>
 
 #ifdef TOOLS_ENABLED
 #include <godot_cpp/classes/editor_interface.hpp>
-#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/resource_loader.hpp>
 #include <godot_cpp/classes/texture2d.hpp>
 #include <godot_cpp/classes/theme.hpp>
@@ -15,6 +23,8 @@
 
 using namespace godot;
 
+static CurveMeshScheduler *curve_mesh_scheduler = nullptr;
+
 #ifdef TOOLS_ENABLED
 namespace
 {
@@ -63,7 +73,18 @@ void initialize_curve_mesh_module(ModuleInitializationLevel p_level)
     switch (p_level)
     {
     case MODULE_INITIALIZATION_LEVEL_SCENE:
+        initialize_curve_mesh_profiler();
+        ClassDB::register_class<CurveDataFile>();
+        ClassDB::register_class<CurveGraphMesh>();
         ClassDB::register_class<CurveMesh>();
+        ClassDB::register_class<CurveMeshBaker>();
+        ClassDB::register_class<CurveMeshExporter>();
+        ClassDB::register_class<CurveMeshScheduler>();
+        ClassDB::register_class<CurveMeshStreamer>();
+        ClassDB::register_class<CurveRope>();
+        curve_mesh_scheduler = memnew(CurveMeshScheduler);
+        Engine::get_singleton()->register_singleton("CurveMeshScheduler",
+                                                    curve_mesh_scheduler);
         break;
 #ifdef TOOLS_ENABLED
     case MODULE_INITIALIZATION_LEVEL_EDITOR:
@@ -80,6 +101,9 @@ void uninitialize_curve_mesh_module(ModuleInitializationLevel p_level)
     switch (p_level)
     {
     case MODULE_INITIALIZATION_LEVEL_SCENE:
+        Engine::get_singleton()->unregister_singleton("CurveMeshScheduler");
+        memdelete(curve_mesh_scheduler);
+        curve_mesh_scheduler = nullptr;
         break;
     default:
         break;
@@ -0,0 +1,255 @@
+#include "vertex_cache_optimizer.h"
+
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+namespace godot
+{
+
+namespace
+{
+static constexpr float CACHE_DECAY_POWER = 1.5f;
+static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+static float _vertex_score(int cache_position, int remaining_triangles)
+{
+    if (remaining_triangles <= 0)
+    {
+        return -1.0f;
+    }
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+        {
+            score = LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            const float scaler =
+                1.0f / (VertexCacheOptimizer::CACHE_SIZE - 3);
+            score = Math::pow(1.0f - (cache_position - 3) * scaler,
+                              CACHE_DECAY_POWER);
+        }
+    }
+
+    score += VALENCE_BOOST_SCALE *
+             Math::pow((float)remaining_triangles, -VALENCE_BOOST_POWER);
+    return score;
+}
+} // namespace
+
+float VertexCacheOptimizer::compute_acmr(const PackedInt32Array &p_indices,
+                                         int p_vertex_count)
+{
+    const int index_count = p_indices.size();
+    if (index_count < 3 || p_vertex_count <= 0)
+    {
+        return 0.0f;
+    }
+
+    // Vertices remember the miss counter at which they entered the FIFO;
+    // they are still cached while fewer than CACHE_SIZE misses followed.
+    LocalVector<int> entered_at;
+    entered_at.resize(p_vertex_count);
+    for (int i = 0; i < p_vertex_count; i++)
+    {
+        entered_at[i] = -CACHE_SIZE - 1;
+    }
+
+    const int32_t *indices = p_indices.ptr();
+    int misses = 0;
+    for (int i = 0; i < index_count; i++)
+    {
+        const int vertex = indices[i];
+        if (misses - entered_at[vertex] > CACHE_SIZE)
+        {
+            entered_at[vertex] = misses;
+            misses++;
+        }
+    }
+
+    return (float)misses / (float)(index_count / 3);
+}
+
+void VertexCacheOptimizer::optimize(PackedInt32Array &p_indices,
+                                    int p_vertex_count)
+{
+    const int triangle_count = p_indices.size() / 3;
+    if (triangle_count < 2 || p_vertex_count <= 0)
+    {
+        return;
+    }
+
+    const int32_t *indices = p_indices.ptr();
+
+    // Per-vertex adjacency in compressed rows. Each row keeps the triangles
+    // that still have to be emitted in its first `remaining` entries.
+    LocalVector<int> adjacency_offset;
+    LocalVector<int> remaining;
+    adjacency_offset.resize(p_vertex_count + 1);
+    remaining.resize(p_vertex_count);
+    for (int v = 0; v < p_vertex_count; v++)
+    {
+        remaining[v] = 0;
+    }
+    for (int i = 0; i < triangle_count * 3; i++)
+    {
+        remaining[indices[i]]++;
+    }
+
+    adjacency_offset[0] = 0;
+    for (int v = 0; v < p_vertex_count; v++)
+    {
+        adjacency_offset[v + 1] = adjacency_offset[v] + remaining[v];
+    }
+
+    LocalVector<int> adjacency;
+    adjacency.resize(triangle_count * 3);
+    LocalVector<int> fill;
+    fill.resize(p_vertex_count);
+    for (int v = 0; v < p_vertex_count; v++)
+    {
+        fill[v] = adjacency_offset[v];
+    }
+    for (int t = 0; t < triangle_count; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            const int vertex = indices[t * 3 + k];
+            adjacency[fill[vertex]++] = t;
+        }
+    }
+
+    LocalVector<int> cache_position;
+    LocalVector<float> vertex_score;
+    cache_position.resize(p_vertex_count);
+    vertex_score.resize(p_vertex_count);
+    for (int v = 0; v < p_vertex_count; v++)
+    {
+        cache_position[v] = -1;
+        vertex_score[v] = _vertex_score(-1, remaining[v]);
+    }
+
+    LocalVector<float> triangle_score;
+    LocalVector<uint8_t> triangle_added;
+    triangle_score.resize(triangle_count);
+    triangle_added.resize(triangle_count);
+    int best_triangle = -1;
+    float best_score = -1.0f;
+    for (int t = 0; t < triangle_count; t++)
+    {
+        triangle_added[t] = 0;
+        triangle_score[t] = vertex_score[indices[t * 3]] +
+                            vertex_score[indices[t * 3 + 1]] +
+                            vertex_score[indices[t * 3 + 2]];
+        if (triangle_score[t] > best_score)
+        {
+            best_score = triangle_score[t];
+            best_triangle = t;
+        }
+    }
+
+    PackedInt32Array result;
+    result.resize(triangle_count * 3);
+    int32_t *output = result.ptrw();
+
+    LocalVector<int> cache;
+    LocalVector<int> new_cache;
+    cache.reserve(CACHE_SIZE + 3);
+    new_cache.reserve(CACHE_SIZE + 3);
+
+    int scan_cursor = 0;
+    for (int emitted = 0; emitted < triangle_count; emitted++)
+    {
+        if (best_triangle < 0)
+        {
+            // Nothing in the cache is connected to unemitted triangles;
+            // resume with the next triangle in the original order.
+            while (triangle_added[scan_cursor])
+            {
+                scan_cursor++;
+            }
+            best_triangle = scan_cursor;
+        }
+
+        const int triangle = best_triangle;
+        triangle_added[triangle] = 1;
+
+        new_cache.clear();
+        for (int k = 0; k < 3; k++)
+        {
+            const int vertex = indices[triangle * 3 + k];
+            output[emitted * 3 + k] = vertex;
+            new_cache.push_back(vertex);
+
+            const int row = adjacency_offset[vertex];
+            for (int a = 0; a < remaining[vertex]; a++)
+            {
+                if (adjacency[row + a] == triangle)
+                {
+                    adjacency[row + a] = adjacency[row + remaining[vertex] - 1];
+                    break;
+                }
+            }
+            remaining[vertex]--;
+        }
+
+        for (uint32_t c = 0; c < cache.size(); c++)
+        {
+            const int vertex = cache[c];
+            if (vertex != new_cache[0] && vertex != new_cache[1] &&
+                vertex != new_cache[2])
+            {
+                new_cache.push_back(vertex);
+            }
+        }
+
+        for (uint32_t c = CACHE_SIZE; c < new_cache.size(); c++)
+        {
+            const int vertex = new_cache[c];
+            cache_position[vertex] = -1;
+            vertex_score[vertex] = _vertex_score(-1, remaining[vertex]);
+        }
+        if (new_cache.size() > (uint32_t)CACHE_SIZE)
+        {
+            new_cache.resize(CACHE_SIZE);
+        }
+
+        for (uint32_t c = 0; c < new_cache.size(); c++)
+        {
+            const int vertex = new_cache[c];
+            cache_position[vertex] = c;
+            vertex_score[vertex] = _vertex_score(c, remaining[vertex]);
+        }
+
+        best_triangle = -1;
+        best_score = -1.0f;
+        for (uint32_t c = 0; c < new_cache.size(); c++)
+        {
+            const int vertex = new_cache[c];
+            const int row = adjacency_offset[vertex];
+            for (int a = 0; a < remaining[vertex]; a++)
+            {
+                const int t = adjacency[row + a];
+                triangle_score[t] = vertex_score[indices[t * 3]] +
+                                    vertex_score[indices[t * 3 + 1]] +
+                                    vertex_score[indices[t * 3 + 2]];
+                if (triangle_score[t] > best_score)
+                {
+                    best_score = triangle_score[t];
+                    best_triangle = t;
+                }
+            }
+        }
+
+        SWAP(cache, new_cache);
+    }
+
+    p_indices = result;
+}
+
+} // namespace godot
@@ -0,0 +1,27 @@
+#ifndef VERTEX_CACHE_OPTIMIZER_H
+#define VERTEX_CACHE_OPTIMIZER_H
+
+#include <godot_cpp/variant/packed_int32_array.hpp>
+
+namespace godot
+{
+
+// Reorders triangle lists for the GPU post-transform vertex cache using
+// Tom Forsyth's linear-speed vertex cache optimisation.
+class VertexCacheOptimizer
+{
+  public:
+    static constexpr int CACHE_SIZE = 32;
+
+    // Average cache miss ratio (transformed vertices per triangle) of a
+    // simulated FIFO cache of CACHE_SIZE entries.
+    static float compute_acmr(const PackedInt32Array &p_indices,
+                              int p_vertex_count);
+
+    // Reorders the triangles in place. Winding of every triangle is kept.
+    static void optimize(PackedInt32Array &p_indices, int p_vertex_count);
+};
+
+} // namespace godot
+
+#endif // VERTEX_CACHE_OPTIMIZER_H
@@ -0,0 +1,41 @@
+# Bakes a directory of Curve3D and CurveMesh resources into ArrayMesh files.
+#
+# godot --headless --path <project> \
+#     --script res://addons/curve_mesh/tools/bake_curve_meshes.gd -- \
+#     <input_dir> <output_dir> [--lods] [--compress] [--force] [--batch=<n>]
+#
+# Inputs that have not changed since the last run are skipped. The exit code
+# is 1 if any input failed to bake.
+extends SceneTree
+
+
+func _initialize() -> void:
+	var paths: PackedStringArray = []
+	var baker := CurveMeshBaker.new()
+	for arg in OS.get_cmdline_user_args():
+		if arg == "--lods":
+			baker.generate_lods = true
+		elif arg == "--compress":
+			baker.compress_attributes = true
+		elif arg == "--force":
+			baker.force = true
+		elif arg.begins_with("--batch="):
+			baker.batch_size = arg.trim_prefix("--batch=").to_int()
+		elif arg.begins_with("--"):
+			printerr("Unknown option: ", arg)
+			quit(2)
+			return
+		else:
+			paths.append(arg)
+
+	if paths.size() != 2:
+		printerr("Usage: -- <input_dir> <output_dir> [--lods] [--compress] [--force] [--batch=<n>]")
+		quit(2)
+		return
+
+	var start := Time.get_ticks_msec()
+	var result := baker.bake_directory(paths[0], paths[1])
+	print("Baked %d, skipped %d, ignored %d, failed %d in %.1f s." % [
+		result.baked, result.skipped, result.ignored, result.failed,
+		(Time.get_ticks_msec() - start) / 1000.0])
+	quit(1 if result.failed > 0 else 0)